@@ -0,0 +1,185 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+ArcReplacer::ArcReplacer(size_t num_frames)
+    : num_frames_(num_frames + 1),
+      capacity_(std::max<size_t>(num_frames, 1)),
+      list_(num_frames + 1, List::None),
+      is_evictable_(num_frames + 1),
+      last_access_(num_frames + 1),
+      page_id_(num_frames + 1, INVALID_PAGE_ID) {}
+
+void ArcReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range");
+  }
+}
+
+auto ArcReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (t1_.empty() && t2_.empty()) {
+    return false;
+  }
+  *frame_id = (PreferT1() ? t1_ : t2_).begin()->second;
+  Untrack(*frame_id, true);
+  return true;
+}
+
+void ArcReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  const size_t now = current_timestamp_++;
+  const bool is_scan = access_type == AccessType::Scan || access_type == AccessType::Prefetch;
+
+  if (list_[frame_id] != List::None) {
+    // 命中：T1里的帧移到T2（扫描和预读除外），T2里的帧移到最近端
+    List target = list_[frame_id] == List::T1 && is_scan ? List::T1 : List::T2;
+    if (is_evictable_[frame_id]) {
+      EvictableSet(list_[frame_id]).erase({last_access_[frame_id], frame_id});
+      EvictableSet(target).emplace(now, frame_id);
+    }
+    if (list_[frame_id] != target) {
+      t1_size_--;
+      t2_size_++;
+      list_[frame_id] = target;
+    }
+    last_access_[frame_id] = now;
+    return;
+  }
+
+  // 新载入的页：在幽灵列表里命中时调整p，然后进入T2；否则进入T1
+  const page_id_t page_id = page_id_[frame_id];
+  List target = List::T1;
+  if (page_id != INVALID_PAGE_ID && !is_scan) {
+    if (b1_.Contains(page_id)) {
+      p_ = std::min(capacity_, p_ + std::max<size_t>(b2_.Size() / b1_.Size(), 1));
+      b1_.Erase(page_id);
+      target = List::T2;
+    } else if (b2_.Contains(page_id)) {
+      const size_t delta = std::max<size_t>(b1_.Size() / b2_.Size(), 1);
+      p_ = p_ > delta ? p_ - delta : 0;
+      b2_.Erase(page_id);
+      target = List::T2;
+    }
+  }
+  list_[frame_id] = target;
+  is_evictable_[frame_id] = false;
+  last_access_[frame_id] = now;
+  if (target == List::T1) {
+    t1_size_++;
+  } else {
+    t2_size_++;
+  }
+  TrimGhosts();
+}
+
+void ArcReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  if (list_[frame_id] == List::None || is_evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  is_evictable_[frame_id] = set_evictable;
+  auto &set = EvictableSet(list_[frame_id]);
+  if (set_evictable) {
+    set.emplace(last_access_[frame_id], frame_id);
+  } else {
+    set.erase({last_access_[frame_id], frame_id});
+  }
+}
+
+void ArcReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_ || !is_evictable_[frame_id]) {
+    return;
+  }
+  Untrack(frame_id, false);
+}
+
+auto ArcReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return t1_.size() + t2_.size();
+}
+
+auto ArcReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<frame_id_t> candidates;
+  const auto &first = PreferT1() ? t1_ : t2_;
+  const auto &second = PreferT1() ? t2_ : t1_;
+  for (const auto *set : {&first, &second}) {
+    for (auto it = set->begin(); it != set->end() && candidates.size() < max_frames; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+  return candidates;
+}
+
+void ArcReplacer::SetPageId(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  page_id_[frame_id] = page_id;
+}
+
+void ArcReplacer::Untrack(frame_id_t frame_id, bool remember) {
+  const List list = list_[frame_id];
+  EvictableSet(list).erase({last_access_[frame_id], frame_id});
+  if (list == List::T1) {
+    t1_size_--;
+  } else {
+    t2_size_--;
+  }
+  list_[frame_id] = List::None;
+  is_evictable_[frame_id] = false;
+
+  const page_id_t page_id = page_id_[frame_id];
+  page_id_[frame_id] = INVALID_PAGE_ID;
+  if (!remember || page_id == INVALID_PAGE_ID || b1_.Contains(page_id) || b2_.Contains(page_id)) {
+    return;
+  }
+  (list == List::T1 ? b1_ : b2_).PushFront(page_id);
+  TrimGhosts();
+}
+
+void ArcReplacer::TrimGhosts() {
+  // |T1| + |B1| <= c，且 |T1| + |T2| + |B1| + |B2| <= 2c
+  while (b1_.Size() > 0 && t1_size_ + b1_.Size() > capacity_) {
+    b1_.PopBack();
+  }
+  while (b2_.Size() > 0 && t1_size_ + t2_size_ + b1_.Size() + b2_.Size() > 2 * capacity_) {
+    b2_.PopBack();
+  }
+}
+
+void ArcReplacer::Resize(size_t num_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  capacity_ = std::max<size_t>(num_frames, 1);
+  p_ = std::min(p_, capacity_);
+  TrimGhosts();
+  if (num_frames + 1 <= num_frames_) {
+    return;
+  }
+  num_frames_ = num_frames + 1;
+  list_.resize(num_frames_, List::None);
+  is_evictable_.resize(num_frames_);
+  last_access_.resize(num_frames_);
+  page_id_.resize(num_frames_, INVALID_PAGE_ID);
+}
+
+}  // namespace bustub
@@ -12,23 +12,79 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <future>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_q_replacer.h"
 #include "common/exception.h"
 #include "common/macros.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+namespace {
+
+auto MakeReplacer(ReplacerType replacer_type, size_t pool_size, size_t replacer_k) -> std::unique_ptr<Replacer> {
+  switch (replacer_type) {
+    case ReplacerType::LRUK:
+      return std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+    case ReplacerType::LRU:
+      return std::make_unique<LRUReplacer>(pool_size);
+    case ReplacerType::Clock:
+      return std::make_unique<ClockReplacer>(pool_size);
+    case ReplacerType::TwoQ:
+      return std::make_unique<TwoQReplacer>(pool_size);
+    case ReplacerType::ARC:
+      return std::make_unique<ArcReplacer>(pool_size);
+  }
+  UNREACHABLE("unknown replacer type");
+}
+
+}  // namespace
+
 BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManager(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_type) {}
+
+BufferPoolManager::BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                     DiskManager *disk_manager, size_t replacer_k, LogManager *log_manager,
+                                     ReplacerType replacer_type)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      next_page_id_(static_cast<page_id_t>(instance_index)),
+      disk_manager_(disk_manager),
+      disk_scheduler_(std::make_unique<DiskScheduler>(disk_manager)),
+      log_manager_(log_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(instance_index < num_instances,
+                "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should "
+                "just be 0.");
+
   // TODO(students): remove this line after you have implemented the buffer pool manager
   // throw NotImplementedException(
   //     "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
   //     "exception line in `buffer_pool_manager.cpp`.");
 
+  // 重新打开的数据库文件里已经有页面了，新页号从文件末尾接着分配，DeletePage也才认得这些页
+  const page_id_t num_pages_on_disk = disk_manager_->GetFreePageMap()->GetNumPagesOnDisk();
+  if (num_pages_on_disk > next_page_id_) {
+    const auto stride = static_cast<page_id_t>(num_instances);
+    next_page_id_ += (num_pages_on_disk - next_page_id_ + stride - 1) / stride * stride;
+  }
+
   // we allocate a consecutive memory space for the buffer pool
-  pages_ = new Page[pool_size_];
-  replacer_ = std::make_unique<LRUKReplacer>(pool_size, replacer_k);
+  frame_layout_ = buffer_pool_frame_layout.load();
+  AddFrameSegment(pool_size_);
+  page_table_.Reserve(pool_size_);
+  replacer_ = MakeReplacer(replacer_type, pool_size, replacer_k);
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -36,182 +92,962 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
   }
 }
 
-BufferPoolManager::~BufferPoolManager() { delete[] pages_; }
+BufferPoolManager::~BufferPoolManager() {
+  BufferPoolManager::StopBackgroundWriter();
+  StopPrefetch();
+  while (num_segments_ > 0) {
+    FreeLastFrameSegment();
+  }
+}
 
-auto BufferPoolManager::NewPage(page_id_t *page_id) -> Page * {
-  const std::lock_guard<std::mutex> guard(latch_);
-  // 先申请一个物理页号，下面要考虑存储在缓冲池的那个页当中
-  int new_page_id = AllocatePage();
+auto BufferPoolManager::NewPage(page_id_t *page_id, page_id_t hint) -> Page * {
+  // 空闲页位图有自己的锁，在拿latch_之前做
+  page_id_t new_page_id = AllocatePage(hint);
+  std::unique_lock<TimedMutex> lock(latch_);
+  if (new_page_id != INVALID_PAGE_ID && !DropStalePage(new_page_id)) {
+    new_page_id = INVALID_PAGE_ID;  // 旧的副本还pin着，这个页号就不用了
+  }
+  // 复用的页在磁盘上还是被删除的页的内容，清空之后要当成脏页写回
+  const bool reused = new_page_id != INVALID_PAGE_ID;
   frame_id_t frame_id;
-  // 先从空闲列表中申请
-  if (!free_list_.empty()) {
-    frame_id = free_list_.back();
-    free_list_.pop_back();
-  } else {
-    // 空闲列表为空就淘汰一个页面
-    if (!replacer_->Evict(&frame_id)) {
-      return nullptr;
+  page_id_t victim_page_id;
+  // 先从空闲列表中申请，空闲列表为空就淘汰一个页面
+  if (!AcquireFrame(&frame_id, &victim_page_id)) {
+    lock.unlock();
+    if (new_page_id != INVALID_PAGE_ID) {
+      DeallocatePage(new_page_id);  // 还回去
     }
-    // 这时候删除的缓冲池页号就存储在了frame_id
-    // 脏读就要重新写会内存，上面的只是把id删除了，但是物理内存还没有操作
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-      pages_[frame_id].is_dirty_ = false;
-    }
-    page_table_.erase(pages_[frame_id].GetPageId());  // pages_[frame_id].GetPageId()能够返回对应的磁盘页面号
+    return nullptr;
+  }
+  if (new_page_id == INVALID_PAGE_ID) {
+    // 拿到帧之后再申请新的物理页号，这样失败的时候不会浪费页号
+    new_page_id = AllocateNewPageId();
   }
+  new_pages_.Add();
   // 建立物理页到实际页的映射
-  page_table_[new_page_id] = frame_id;
-  // 这里创建了一个指针指向新创建的这个页，因为最终返回是一个指针
-  auto &current_page = pages_[frame_id];
-  // 这个是这个磁盘页的属性，记录其存储的物理内存页号是多少
+  page_table_.Insert(new_page_id, frame_id);
+  auto &current_page = GetFrame(frame_id);
   current_page.page_id_ = new_page_id;
-  current_page.ResetMemory();  // 清空datau数据
-  current_page.is_dirty_ = false;
-  current_page.pin_count_ = 1;  // pin_count此页面的固定次数，当前正在使用所以标为1，后面要手动释放他
+  current_page.is_dirty_ = reused;
+  // pin_count此页面的固定次数，当前正在使用所以标为1，后面要手动释放他；最后才写，写完别的线程就能pin这个页面了
+  current_page.pin_count_.store(1, std::memory_order_release);
 
   // LRU-K对页面进行管理
+  replacer_->SetPageId(frame_id, new_page_id);
   replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);  // 把这个页面设置成不可驱逐
+  Park(frame_id);  // 把这个页面设置成不可驱逐
+
+  // 写回旧页面和清空数据都不需要持有latch_
+  LoadFrame(&lock, frame_id, victim_page_id, false);
 
   *page_id = new_page_id;  // 返回创建的缓冲池号
   return &current_page;
 }
 
-auto BufferPoolManager::FetchPage(page_id_t page_id, [[maybe_unused]] AccessType access_type) -> Page * {
-  const std::lock_guard<std::mutex> guard(latch_);
+auto BufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  // 命中的时候不拿latch_
+  if (auto *page = PinResidentPage(page_id, access_type); page != nullptr) {
+    return page;
+  }
+  // 多半要读盘了，在拿latch_之前告诉disk manager，让它可以提前预读
+  disk_manager_->AdviseAccess(page_id, access_type);
+
+  std::unique_lock<TimedMutex> lock(latch_);
   frame_id_t frame_id;
-  // 判断是不是在缓冲池中
-  if (page_table_.find(page_id) != page_table_.end()) {
-    frame_id = page_table_[page_id];
-    // 确实只有在重复访问现有磁盘的时候才++
-    pages_[frame_id].pin_count_++;  // 说明正在使用，这个在取完数据之后就使用unpin释放掉了,这样就不会删除这个页面了，
-    // 更新RLU-K
-    replacer_->RecordAccess(frame_id);
-    replacer_->SetEvictable(frame_id, false);
-    return &pages_[frame_id];  // 要返回一直指针
+  while (true) {
+    // 判断是不是在缓冲池中，持有latch_的时候查到的结果是准确的
+    if (page_table_.Find(page_id, &frame_id)) {
+      auto &page = GetFrame(frame_id);
+      // 确实只有在重复访问现有磁盘的时候才++
+      page.pin_count_++;  // 说明正在使用，这个在取完数据之后就使用unpin释放掉了,这样就不会删除这个页面了，
+      // 更新RLU-K
+      replacer_->RecordAccess(frame_id, access_type);
+      Park(frame_id);
+      if (access_type != AccessType::Prefetch) {
+        hits_.Add();
+      }
+      // 别的线程正在从磁盘读这个页面，等它读完
+      if (page.io_in_progress_) {
+        pin_waits_.Add();
+        page.io_cv_.wait(lock, [&page] { return !page.io_in_progress_; });
+      }
+      return &page;  // 要返回一直指针
+    }
+    // 这个页面刚被换出，正在写回磁盘，写完之后才能从磁盘重新读
+    auto write_back = writing_back_.find(page_id);
+    if (write_back == writing_back_.end()) {
+      break;
+    }
+    pin_waits_.Add();
+    GetFrame(write_back->second).io_cv_.wait(lock);
   }
+
   // 在缓冲池当中没有找到的话，就要去磁盘中读取
-  if (!free_list_.empty()) {
-    // 先从空闲链表
-    frame_id = free_list_.back();
-    free_list_.pop_back();
-  } else {
-    // 需要替换
-    if (!replacer_->Evict(&frame_id)) {
-      return nullptr;
+  page_id_t victim_page_id;
+  if (!AcquireFrame(&frame_id, &victim_page_id)) {
+    return nullptr;
+  }
+
+  (access_type == AccessType::Prefetch ? prefetch_reads_ : misses_).Add();
+  page_table_.Insert(page_id, frame_id);
+  // 缓存区页面的元属性
+  auto &page = GetFrame(frame_id);
+  page.page_id_ = page_id;
+  page.is_dirty_ = false;
+  page.pin_count_.store(1, std::memory_order_release);  // 新创建的时候就直接赋值为1
+  replacer_->SetPageId(frame_id, page_id);
+  replacer_->RecordAccess(frame_id, access_type);
+  Park(frame_id);
+
+  LoadFrame(&lock, frame_id, victim_page_id, true);
+  return &page;
+}
+auto BufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> std::vector<Page *> {
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  std::vector<FrameLoad> loads;
+  // 正在写回磁盘的页面要等写完才能读，这种少见的情况之后单独走FetchPage
+  std::vector<size_t> written_back;
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      disk_manager_->AdviseAccess(page_id, access_type);
+    }
+  }
+  std::unique_lock<TimedMutex> lock(latch_);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    const page_id_t page_id = page_ids[i];
+    if (page_id == INVALID_PAGE_ID) {
+      continue;
     }
-    // 这时候如果淘汰成功，就把淘汰的页号存储在了frame_id中，并且u删除了RLU中所有的记录
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-      pages_[frame_id].is_dirty_ = false;
+    frame_id_t frame_id;
+    if (page_table_.Find(page_id, &frame_id)) {
+      auto &page = GetFrame(frame_id);
+      page.pin_count_++;
+      replacer_->RecordAccess(frame_id, access_type);
+      Park(frame_id);
+      hits_.Add();
+      pages[i] = &page;
+      continue;
     }
-    page_table_.erase(pages_[frame_id].GetPageId());
+    if (writing_back_.find(page_id) != writing_back_.end()) {
+      written_back.push_back(i);
+      continue;
+    }
+    page_id_t victim_page_id;
+    if (!AcquireFrame(&frame_id, &victim_page_id)) {
+      continue;
+    }
+    misses_.Add();
+    page_table_.Insert(page_id, frame_id);
+    auto &page = GetFrame(frame_id);
+    page.page_id_ = page_id;
+    page.is_dirty_ = false;
+    // 同一批里后面再出现这个页面的时候，要等它读完；io_in_progress_已经由AcquireFrame()设置好了
+    page.pin_count_.store(1, std::memory_order_release);
+    replacer_->SetPageId(frame_id, page_id);
+    replacer_->RecordAccess(frame_id, access_type);
+    Park(frame_id);
+    loads.push_back({frame_id, victim_page_id, true});
+    pages[i] = &page;
   }
 
-  page_table_[page_id] = frame_id;
-  // 缓存区页面的元属性
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 1;  // 新创建的时候就直接赋值为1
+  LoadFrames(&lock, loads);
+  // 命中的页面可能还在被别的线程读
+  for (auto *page : pages) {
+    if (page != nullptr && page->io_in_progress_) {
+      pin_waits_.Add();
+      page->io_cv_.wait(lock, [page] { return !page->io_in_progress_; });
+    }
+  }
+  lock.unlock();
 
-  disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
-  replacer_->RecordAccess(frame_id);
-  replacer_->SetEvictable(frame_id, false);
-  return &pages_[frame_id];
+  for (auto i : written_back) {
+    pages[i] = BufferPoolManager::FetchPage(page_ids[i], access_type);
+  }
+  return pages;
 }
+
+auto BufferPoolManager::NewPages(size_t num_pages, std::vector<page_id_t> *page_ids, page_id_t hint)
+    -> std::vector<Page *> {
+  // 空闲页位图有自己的锁，在拿latch_之前做，后一个页尽量挨着前一个页
+  std::vector<page_id_t> new_page_ids(num_pages);
+  for (auto &new_page_id : new_page_ids) {
+    new_page_id = AllocatePage(hint);
+    if (new_page_id != INVALID_PAGE_ID) {
+      hint = new_page_id;
+    }
+  }
+
+  std::vector<Page *> pages;
+  std::vector<FrameLoad> loads;
+  page_ids->clear();
+  std::unique_lock<TimedMutex> lock(latch_);
+  size_t i = 0;
+  for (; i < num_pages; i++) {
+    frame_id_t frame_id;
+    page_id_t victim_page_id;
+    if (!AcquireFrame(&frame_id, &victim_page_id)) {
+      break;
+    }
+    page_id_t new_page_id = new_page_ids[i];
+    if (new_page_id != INVALID_PAGE_ID && !DropStalePage(new_page_id)) {
+      new_page_id = INVALID_PAGE_ID;
+    }
+    const bool reused = new_page_id != INVALID_PAGE_ID;
+    if (new_page_id == INVALID_PAGE_ID) {
+      new_page_id = AllocateNewPageId();
+    }
+    new_pages_.Add();
+    page_table_.Insert(new_page_id, frame_id);
+    auto &page = GetFrame(frame_id);
+    page.page_id_ = new_page_id;
+    page.is_dirty_ = reused;
+    page.pin_count_.store(1, std::memory_order_release);
+    replacer_->SetPageId(frame_id, new_page_id);
+    replacer_->RecordAccess(frame_id);
+    Park(frame_id);
+    loads.push_back({frame_id, victim_page_id, false});
+    pages.push_back(&page);
+    page_ids->push_back(new_page_id);
+  }
+  LoadFrames(&lock, loads);
+  lock.unlock();
+
+  // 没拿到帧的页还回去
+  for (; i < num_pages; i++) {
+    if (new_page_ids[i] != INVALID_PAGE_ID) {
+      DeallocatePage(new_page_ids[i]);
+    }
+  }
+  return pages;
+}
+
 // 这个就是给指定页面接触固定，因为在其他文件中，都会给这个页面在RLU中设置成不可驱逐，没有地方修改，这里就可以修改
 // 对一个页操作完之后就要unpin
 auto BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, [[maybe_unused]] AccessType access_type) -> bool {
-  const std::lock_guard<std::mutex> guard(latch_);
   // 是个是看到底物理页面有没有写入到磁盘当中
   if (page_id == INVALID_PAGE_ID) {
     return false;
   }
-  if (page_table_.find(page_id) == page_table_.end()) {
+  // 被pin住的页面不会被换出，所以不拿latch_查到的帧就是对的；没查到可能是正好碰上页表在挪动，拿latch_再查一次
+  frame_id_t frame_id;
+  if (page_table_.Find(page_id, &frame_id)) {
+    auto &page = GetFrame(frame_id);
+    if (page.page_id_.load(std::memory_order_acquire) == page_id) {
+      return ReleasePin(&page, is_dirty);
+    }
+  }
+  const std::lock_guard<TimedMutex> guard(latch_);
+  if (!page_table_.Find(page_id, &frame_id)) {
     return false;
   }
-  auto frame_id = page_table_[page_id];
+  return ReleasePin(&GetFrame(frame_id), is_dirty);
+}
+
+auto BufferPoolManager::ReleasePin(Page *page, bool is_dirty) -> bool {
   //  不能把原来脏的状态取消，// 保留原来的脏状态，如果新传入的 `is_dirty` 为真，则将页面标记为脏
-  pages_[frame_id].is_dirty_ |= is_dirty;
-  if (pages_[frame_id].pin_count_ > 0) {
-    pages_[frame_id].pin_count_--;
-    if (pages_[frame_id].pin_count_ == 0) {
-      replacer_->SetEvictable(frame_id, true);  // 没有人再用的时候就会使用RLU规则删除了
+  // 要在减pin_count之前标脏，换出页面的线程看到pin_count为0的时候一定也能看到脏标记
+  if (is_dirty) {
+    page->is_dirty_.store(true, std::memory_order_relaxed);
+  }
+  // 减到0之后这个帧就可以被换出了，replacer会在下一次换出的时候知道，见UnparkFrames()
+  int pin_count = page->pin_count_.load(std::memory_order_relaxed);
+  while (pin_count > 0) {
+    if (page->pin_count_.compare_exchange_weak(pin_count, pin_count - 1, std::memory_order_release)) {
+      return true;
     }
-    return true;
   }
   return false;
 }
 // 就是把这个页面刷到磁盘上
 auto BufferPoolManager::FlushPage(page_id_t page_id) -> bool {
-  const std::lock_guard<std::mutex> guard(latch_);
+  std::unique_lock<TimedMutex> lock(latch_);
   if (page_id == INVALID_PAGE_ID) {
     return false;
   }
-  if (page_table_.find(page_id) == page_table_.end()) {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
     return false;
   }
-  auto frame_id = page_table_[page_id];
-  disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-  pages_[frame_id].is_dirty_ = false;
+  auto &page = GetFrame(frame_id);
+  // 写盘的时候不持有latch_，先pin住这个页面，防止它在写盘期间被换出
+  page.pin_count_++;
+  page.io_cv_.wait(lock, [&page] { return !page.io_in_progress_; });
+  // 先清掉脏标记，写盘期间别的线程再把它标脏的话，这个标记会保留下来
+  page.is_dirty_ = false;
+  lock.unlock();
+
+  disk_scheduler_->ScheduleWrite(page_id, page.GetData()).get();
+  page.pin_count_--;
   return true;
 }
 
 void BufferPoolManager::FlushAllPages() {
-  const std::lock_guard<std::mutex> guard(latch_);
+  // 空闲页位图也写回，和数据页一起sync
+  disk_manager_->GetFreePageMap()->Flush();
+  std::vector<Page *> pages;
+  PinDirtyPages(&pages);
+  WriteDirtyPages(disk_manager_, pages);
+}
+
+void BufferPoolManager::PinDirtyPages(std::vector<Page *> *pages) {
+  const std::lock_guard<TimedMutex> guard(latch_);
   for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].is_dirty_ && pages_[i].page_id_ != INVALID_PAGE_ID) {
-      disk_manager_->WritePage(pages_[i].GetPageId(), pages_[i].GetData());
-      pages_[i].is_dirty_ = false;
+    auto &page = GetFrame(i);
+    frame_id_t frame_id;
+    // 正在读盘的帧不是脏的；换出时的牺牲页已经不在页表里，由换出它的线程写回
+    if (!page.is_dirty_ || page.io_in_progress_ || page.page_id_ == INVALID_PAGE_ID ||
+        !page_table_.Find(page.page_id_, &frame_id) ||
+        frame_id != static_cast<frame_id_t>(i)) {
+      continue;
     }
+    // 和FlushPage()一样，先清掉脏标记，写盘期间别的线程再把它标脏的话，这个标记会保留下来
+    page.pin_count_++;
+    page.is_dirty_ = false;
+    pages->push_back(&page);
+  }
+}
+
+void BufferPoolManager::WriteDirtyPages(DiskManager *disk_manager, const std::vector<Page *> &pages) {
+  if (pages.empty()) {
+    return;
+  }
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  writes.reserve(pages.size());
+  for (auto *page : pages) {
+    writes.emplace_back(page->GetPageId(), page->GetData());
+  }
+  // disk manager按页号排序，相邻的页合并成一次写，最后只sync一次
+  disk_manager->WritePages(std::move(writes));
+  disk_manager->Sync();
+  for (auto *page : pages) {
+    page->pin_count_--;
   }
 }
+
 // 从磁盘中删除 页面，给定物理页面号
 auto BufferPoolManager::DeletePage(page_id_t page_id) -> bool {
-  const std::lock_guard<std::mutex> guard(latch_);
-  if (page_table_.find(page_id) == page_table_.end()) {
+  if (page_id == INVALID_PAGE_ID) {
     return true;
   }
-  auto frame_id = page_table_[page_id];
-  // pin_count != 0 代表是否正在被使用
-  if (pages_[frame_id].pin_count_ != 0) {
-    return false;
+  std::unique_lock<TimedMutex> lock(latch_);
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    // 不在缓冲池里的页面也要释放；没分配过的页号不能放进空闲页位图，不然会被分配两次
+    lock.unlock();
+    if (IsAllocatedPageId(page_id)) {
+      DeallocatePage(page_id);
+    }
+    return true;
   }
-  if (pages_[frame_id].IsDirty()) {
-    disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-    pages_[frame_id].is_dirty_ = false;
+  // pin_count != 0 代表是否正在被使用，正在做I/O的页面也一定是pin住的；改成-1之后命中的线程就pin不住它了
+  auto &page = GetFrame(frame_id);
+  int unpinned = 0;
+  if (!page.pin_count_.compare_exchange_strong(unpinned, -1)) {
+    return false;
   }
-  pages_[frame_id].page_id_ = INVALID_PAGE_ID;  // 代表还没有存储数据
-  pages_[frame_id].ResetMemory();               // 清空datau数据
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 0;
+  // 页面已经被删除了，脏数据不需要再写回磁盘；空闲的帧pin_count保持-1
+  page.page_id_ = INVALID_PAGE_ID;  // 代表还没有存储数据
+  page.ResetMemory();               // 清空datau数据
+  page.is_dirty_ = false;
 
-  page_table_.erase(page_id);
-  replacer_->Remove(frame_id);
+  page_table_.Erase(page_id);
+  ForgetFrame(frame_id);
   free_list_.push_back(frame_id);
+  lock.unlock();
   DeallocatePage(page_id);  // 释放这个内存
   return true;
 }
 
-auto BufferPoolManager::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManager::Resize(size_t new_size) -> bool {
+  if (new_size == 0) {
+    return false;
+  }
+  const std::lock_guard<std::mutex> resize_guard(resize_latch_);
+  std::unique_lock<TimedMutex> lock(latch_);
+  const size_t old_size = pool_size_;
+  if (new_size >= old_size) {
+    // 上次缩小留下的帧先用起来，不够再分配一段新的；新的一段至少和已有的帧一样多，段数只随大小对数增长
+    const auto &last = segments_[num_segments_ - 1];
+    const size_t allocated = last.first_frame_ + last.num_frames_;
+    if (new_size > allocated) {
+      if (num_segments_ == MAX_FRAME_SEGMENTS) {
+        return false;
+      }
+      AddFrameSegment(std::max(new_size - allocated, allocated));
+    }
+    page_table_.Reserve(new_size);
+    replacer_->Resize(new_size);
+    for (size_t i = old_size; i < new_size; i++) {
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+    pool_size_ = new_size;
+    return true;
+  }
 
-auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, FetchPage(page_id)}; }
+  // 要去掉的帧里有脏页的话先写回，写的时候pin住，不持有latch_；写完再从头检查一遍，期间可能又有页面被换进来或者写脏
+  while (true) {
+    std::vector<frame_id_t> dirty_frames;
+    for (size_t i = new_size; i < old_size; i++) {
+      const auto &page = GetFrame(i);
+      if (page.pin_count_ > 0) {
+        return false;
+      }
+      if (page.pin_count_ == 0 && page.is_dirty_) {
+        dirty_frames.push_back(static_cast<frame_id_t>(i));
+      }
+    }
+    if (!dirty_frames.empty()) {
+      for (auto frame_id : dirty_frames) {
+        auto &page = GetFrame(frame_id);
+        page.pin_count_++;
+        page.is_dirty_ = false;
+      }
+      lock.unlock();
+      for (auto frame_id : dirty_frames) {
+        auto &page = GetFrame(frame_id);
+        page.RLatch();
+        disk_scheduler_->ScheduleWrite(page.GetPageId(), page.GetData()).get();
+        page.RUnlatch();
+        page.pin_count_--;
+      }
+      lock.lock();
+      continue;
+    }
 
-auto BufferPoolManager::FetchPageRead(page_id_t page_id) -> ReadPageGuard {
-  auto page = FetchPage(page_id);
+    // 命中不拿latch_，上面检查完之后还可能有线程pin住或者写脏这些页面；pin_count改成-1之后就不会了
+    std::vector<frame_id_t> claimed;
+    bool pinned = false;
+    bool dirty = false;
+    for (size_t i = new_size; i < old_size && !pinned; i++) {
+      auto &page = GetFrame(i);
+      if (page.page_id_ == INVALID_PAGE_ID) {
+        continue;  // 空闲的帧
+      }
+      int unpinned = 0;
+      if (page.pin_count_.compare_exchange_strong(unpinned, -1)) {
+        claimed.push_back(static_cast<frame_id_t>(i));
+        dirty = dirty || page.is_dirty_;
+      } else {
+        pinned = true;
+      }
+    }
+    if (!pinned && !dirty) {
+      break;
+    }
+    for (auto frame_id : claimed) {
+      GetFrame(frame_id).pin_count_ = 0;
+    }
+    if (pinned) {
+      return false;
+    }
+  }
+
+  // 剩下的帧都没有被pin，也都是干净的，直接扔掉
+  free_list_.remove_if([new_size](frame_id_t frame_id) { return static_cast<size_t>(frame_id) >= new_size; });
+  for (size_t i = new_size; i < old_size; i++) {
+    auto &page = GetFrame(i);
+    if (page.page_id_ != INVALID_PAGE_ID) {
+      page_table_.Erase(page.page_id_);
+      ForgetFrame(static_cast<frame_id_t>(i));
+      page.page_id_ = INVALID_PAGE_ID;
+    }
+  }
+  replacer_->Resize(new_size);
+  pool_size_ = new_size;
+  // 命中的线程可能还拿着这些帧的页去比较页号，所以只还数据的内存，页的元数据留着，扩容的时候再用
+  ReleaseFrames(new_size, old_size);
+  return true;
+}
+
+auto BufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  {
+    const std::lock_guard<TimedMutex> guard(latch_);
+    stats.pool_size_ = pool_size_;
+    stats.free_frames_ = free_list_.size();
+    for (size_t i = 0; i < pool_size_; i++) {
+      stats.pinned_frames_ += GetFrame(i).pin_count_ > 0 ? 1 : 0;
+    }
+  }
+  stats.hits_ = hits_.Load();
+  stats.misses_ = misses_.Load();
+  stats.prefetch_reads_ = prefetch_reads_.Load();
+  stats.new_pages_ = new_pages_.Load();
+  stats.evictions_ = evictions_.Load();
+  stats.all_pinned_ = all_pinned_.Load();
+  stats.dirty_write_backs_ = foreground_writes_.Load();
+  stats.background_write_backs_ = background_writes_.Load();
+  stats.pin_waits_ = pin_waits_.Load();
+  stats.latch_acquisitions_ = latch_.GetAcquisitions();
+  stats.latch_hold_ns_ = latch_.GetHoldNanos();
+  stats.replacer_ = replacer_->GetStats();
+  return stats;
+}
+
+void BufferPoolManager::StartBackgroundWriter(size_t batch_size, std::chrono::milliseconds interval) {
+  StopBackgroundWriter();
+  const std::lock_guard<std::mutex> guard(background_writer_latch_);
+  background_writer_stop_ = false;
+  background_writer_ = std::thread([this, batch_size, interval] {
+    std::unique_lock<std::mutex> lock(background_writer_latch_);
+    while (!background_writer_cv_.wait_for(lock, interval, [this] { return background_writer_stop_; })) {
+      lock.unlock();
+      WriteBackEvictionCandidates(batch_size);
+      lock.lock();
+    }
+  });
+}
+
+void BufferPoolManager::StopBackgroundWriter() {
+  std::thread writer;
+  {
+    const std::lock_guard<std::mutex> guard(background_writer_latch_);
+    background_writer_stop_ = true;
+    writer = std::move(background_writer_);
+  }
+  background_writer_cv_.notify_all();
+  if (writer.joinable()) {
+    writer.join();
+  }
+}
+
+auto BufferPoolManager::WriteBackEvictionCandidates(size_t batch_size) -> size_t {
+  // 挑出马上要被淘汰的脏页，先pin住，写盘的时候不持有latch_
+  std::vector<frame_id_t> frame_ids;
+  {
+    const std::lock_guard<TimedMutex> guard(latch_);
+    // 和换出的时候一样，先让replacer知道最近的命中和已经unpin的帧
+    DrainAccesses();
+    UnparkFrames();
+    for (auto frame_id : replacer_->EvictionCandidates(batch_size)) {
+      auto &page = GetFrame(frame_id);
+      if (page.is_dirty_ && page.pin_count_ == 0 && !page.io_in_progress_) {
+        page.pin_count_++;
+        frame_ids.push_back(frame_id);
+      }
+    }
+  }
+
+  size_t num_writes = 0;
+  for (auto frame_id : frame_ids) {
+    auto &page = GetFrame(frame_id);
+    // 持有读锁写盘，写的是一个完整的版本；脏标记在写之前清掉，写盘期间再被改的话会重新标脏
+    page.RLatch();
+    if (page.is_dirty_.exchange(false)) {
+      disk_scheduler_->ScheduleWrite(page.GetPageId(), page.GetData()).get();
+      background_writes_.Add();
+      num_writes++;
+    }
+    page.RUnlatch();
+    page.pin_count_--;
+  }
+  return num_writes;
+}
+
+void BufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids) {
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      EnqueuePrefetch({page_id, 1, nullptr});
+    }
+  }
+}
+
+void BufferPoolManager::PrefetchPageChain(page_id_t page_id, size_t num_pages, NextPageIdFn next_page_id) {
+  if (page_id != INVALID_PAGE_ID && num_pages > 0) {
+    EnqueuePrefetch({page_id, num_pages, next_page_id});
+  }
+}
+
+void BufferPoolManager::EnqueuePrefetch(const PrefetchRequest &request) {
+  const std::lock_guard<std::mutex> guard(prefetch_latch_);
+  // 预读只是优化，队列满了就直接丢掉
+  if (prefetch_stop_ || prefetch_queue_.size() >= GetPoolSize()) {
+    return;
+  }
+  if (prefetch_threads_.empty()) {
+    for (int i = 0; i < BUFFER_POOL_PREFETCH_THREADS; i++) {
+      prefetch_threads_.emplace_back(&BufferPoolManager::PrefetchLoop, this);
+    }
+  }
+  prefetch_queue_.push_back(request);
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManager::PrefetchLoop() {
+  std::unique_lock<std::mutex> lock(prefetch_latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return prefetch_stop_ || !prefetch_queue_.empty(); });
+    if (prefetch_stop_) {
+      return;
+    }
+    auto request = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    lock.unlock();
+
+    // 和普通的读一样走FetchPage，命中或者别的线程正在读这个页面的时候都不会重复读盘
+    auto *page = FetchPage(request.page_id_, AccessType::Prefetch);
+    page_id_t next_page_id = INVALID_PAGE_ID;
+    if (page != nullptr) {
+      if (request.num_pages_ > 1 && request.next_page_id_ != nullptr) {
+        page->RLatch();
+        next_page_id = request.next_page_id_(page->GetData());
+        page->RUnlatch();
+      }
+      UnpinPage(request.page_id_, false, AccessType::Prefetch);
+    }
+
+    lock.lock();
+    // 链表的下一个页面放回队列，让空闲的线程接着读
+    if (next_page_id != INVALID_PAGE_ID && !prefetch_stop_) {
+      prefetch_queue_.push_back({next_page_id, request.num_pages_ - 1, request.next_page_id_});
+      prefetch_cv_.notify_one();
+    }
+  }
+}
+
+void BufferPoolManager::StopPrefetch() {
+  std::vector<std::thread> threads;
+  {
+    const std::lock_guard<std::mutex> guard(prefetch_latch_);
+    prefetch_stop_ = true;
+    prefetch_queue_.clear();
+    threads = std::move(prefetch_threads_);
+  }
+  prefetch_cv_.notify_all();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void BufferPoolManager::AddFrameSegment(size_t num_frames) {
+  auto &segment = segments_[num_segments_];
+  if (num_segments_ > 0) {
+    const auto &last = segments_[num_segments_ - 1];
+    segment.first_frame_ = last.first_frame_ + last.num_frames_;
+  }
+  segment.num_frames_ = num_frames;
+  if (frame_layout_ == FrameLayout::PerPage) {
+    segment.pages_ = new Page[num_frames];
+  } else {
+    // 页的数据都放在frame arena里，页的元数据单独放在一个紧凑的数组里
+    segment.arena_ = std::make_unique<FrameArena>(num_frames, frame_layout_);
+    segment.pages_ = static_cast<Page *>(::operator new[](num_frames * sizeof(Page)));
+    for (size_t i = 0; i < num_frames; ++i) {
+      new (&segment.pages_[i]) Page(segment.arena_->GetFrame(i));
+    }
+  }
+  // 新的帧都放进空闲列表，空闲的帧不能被pin
+  for (size_t i = 0; i < num_frames; ++i) {
+    segment.pages_[i].pin_count_ = -1;
+  }
+  num_segments_++;
+}
+
+void BufferPoolManager::FreeLastFrameSegment() {
+  auto &segment = segments_[--num_segments_];
+  if (segment.arena_ == nullptr) {
+    delete[] segment.pages_;
+  } else {
+    for (size_t i = 0; i < segment.num_frames_; ++i) {
+      segment.pages_[i].~Page();
+    }
+    ::operator delete[](segment.pages_);
+    segment.arena_.reset();
+  }
+  segment = FrameSegment();
+}
+
+void BufferPoolManager::ReleaseFrames(size_t first_frame, size_t last_frame) {
+  for (size_t i = 0; i < num_segments_; i++) {
+    auto &segment = segments_[i];
+    const size_t begin = std::max(first_frame, segment.first_frame_);
+    const size_t end = std::min(last_frame, segment.first_frame_ + segment.num_frames_);
+    if (segment.arena_ != nullptr && begin < end) {
+      segment.arena_->Release(begin - segment.first_frame_, end - begin);
+    }
+  }
+}
+
+auto BufferPoolManager::PinResidentPage(page_id_t page_id, AccessType access_type) -> Page * {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return nullptr;
+  }
+  auto &page = GetFrame(frame_id);
+  if (!TryPin(&page)) {
+    return nullptr;
+  }
+  // 查表和pin之间这个帧可能已经换成了别的页面，pin住之后再看一眼页号，pin住的帧不会再换
+  if (page.page_id_.load(std::memory_order_acquire) != page_id) {
+    page.pin_count_--;
+    return nullptr;
+  }
+  accesses_.Push(page_id, access_type);
+  if (access_type != AccessType::Prefetch) {
+    hits_.Add();
+  }
+  // 别的线程正在从磁盘读这个页面，等它读完
+  if (page.io_in_progress_) {
+    std::unique_lock<TimedMutex> lock(latch_);
+    pin_waits_.Add();
+    page.io_cv_.wait(lock, [&page] { return !page.io_in_progress_; });
+  }
+  return &page;
+}
+
+void BufferPoolManager::DrainAccesses() {
+  accesses_.Drain([this](page_id_t page_id, AccessType access_type) {
+    frame_id_t frame_id;
+    if (!page_table_.Find(page_id, &frame_id)) {
+      return;  // 已经被换出或者删掉了
+    }
+    replacer_->RecordAccess(frame_id, access_type);
+    if (GetFrame(frame_id).pin_count_ > 0) {
+      Park(frame_id);
+    }
+  });
+}
+
+void BufferPoolManager::Park(frame_id_t frame_id) {
+  auto &page = GetFrame(frame_id);
+  replacer_->SetEvictable(frame_id, false);
+  if (!page.parked_) {
+    page.parked_ = true;
+    parked_frames_.push_back(frame_id);
+  }
+}
+
+void BufferPoolManager::UnparkFrames() {
+  for (size_t i = 0; i < parked_frames_.size();) {
+    const frame_id_t frame_id = parked_frames_[i];
+    auto &page = GetFrame(frame_id);
+    if (page.pin_count_ != 0) {
+      i++;
+      continue;
+    }
+    replacer_->SetEvictable(frame_id, true);
+    page.parked_ = false;
+    parked_frames_[i] = parked_frames_.back();
+    parked_frames_.pop_back();
+  }
+}
+
+void BufferPoolManager::ForgetFrame(frame_id_t frame_id) {
+  auto &page = GetFrame(frame_id);
+  if (page.parked_) {
+    page.parked_ = false;
+    parked_frames_.erase(std::find(parked_frames_.begin(), parked_frames_.end(), frame_id));
+  }
+  // Remove()只能删可以驱逐的帧
+  replacer_->SetEvictable(frame_id, true);
+  replacer_->Remove(frame_id);
+}
+
+auto BufferPoolManager::AcquireFrame(frame_id_t *frame_id, page_id_t *victim_page_id) -> bool {
+  *victim_page_id = INVALID_PAGE_ID;
+  // 命中的访问记录先交给replacer，这样它选出来的牺牲页是按最新的访问历史算的
+  DrainAccesses();
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.back();
+    free_list_.pop_back();
+    GetFrame(*frame_id).io_in_progress_ = true;
+    return true;
+  }
+  UnparkFrames();
+  while (replacer_->Evict(frame_id)) {
+    // 命中不拿latch_，replacer选出来的帧可能刚被pin住；pin_count从0改成-1成功了这个帧才归我们
+    auto &page = GetFrame(*frame_id);
+    int unpinned = 0;
+    if (!page.pin_count_.compare_exchange_strong(unpinned, -1, std::memory_order_acquire)) {
+      replacer_->RecordAccess(*frame_id);
+      Park(*frame_id);
+      continue;
+    }
+    evictions_.Add();
+    // 这时候删除的缓冲池页号就存储在了frame_id，脏页还要写回磁盘，由调用者在释放latch_之后去写
+    page_table_.Erase(page.page_id_);
+    if (page.is_dirty_) {
+      *victim_page_id = page.page_id_;
+      writing_back_[page.page_id_] = *frame_id;
+      page.is_dirty_ = false;
+    }
+    page.io_in_progress_ = true;
+    return true;
+  }
+  all_pinned_.Add();
+  return false;
+}
+
+void BufferPoolManager::LoadFrame(std::unique_lock<TimedMutex> *lock, frame_id_t frame_id, page_id_t victim_page_id,
+                                  bool read_from_disk) {
+  LoadFrames(lock, {{frame_id, victim_page_id, read_from_disk}});
+}
+
+void BufferPoolManager::LoadFrames(std::unique_lock<TimedMutex> *lock, const std::vector<FrameLoad> &loads) {
+  if (loads.empty()) {
+    return;
+  }
+  // 其它请求这些页面的线程看到io_in_progress_就会在io_cv_上等待，其余的线程不受影响
+  for (const auto &load : loads) {
+    GetFrame(load.frame_id_).io_in_progress_ = true;
+  }
+  lock->unlock();
+
+  // 所有帧的I/O一起交给disk scheduler；同一个帧要先把牺牲页写回，才能读入新页面
+  std::vector<std::future<bool>> futures;
+  for (const auto &load : loads) {
+    if (load.victim_page_id_ != INVALID_PAGE_ID) {
+      futures.push_back(disk_scheduler_->ScheduleWrite(load.victim_page_id_, GetFrame(load.frame_id_).data_));
+    }
+  }
+  if (!futures.empty()) {
+    for (auto &future : futures) {
+      future.get();
+    }
+    futures.clear();
+    lock->lock();
+    for (const auto &load : loads) {
+      if (load.victim_page_id_ != INVALID_PAGE_ID) {
+        foreground_writes_.Add();
+        writing_back_.erase(load.victim_page_id_);
+        GetFrame(load.frame_id_).io_cv_.notify_all();
+      }
+    }
+    lock->unlock();
+  }
+  for (const auto &load : loads) {
+    auto &page = GetFrame(load.frame_id_);
+    if (load.read_from_disk_) {
+      futures.push_back(disk_scheduler_->ScheduleRead(page.GetPageId(), page.data_));
+    } else {
+      page.ResetMemory();  // 清空datau数据
+    }
+  }
+  for (auto &future : futures) {
+    future.get();
+  }
+
+  lock->lock();
+  for (const auto &load : loads) {
+    auto &page = GetFrame(load.frame_id_);
+    page.io_in_progress_ = false;
+    page.io_cv_.notify_all();
+  }
+}
+
+auto BufferPoolManager::AllocatePage(page_id_t hint) -> page_id_t {
+  // 只拿 page_id % num_instances_ == instance_index_ 的空闲页，这样页面还是由这个实例管理
+  return disk_manager_->GetFreePageMap()->Allocate(hint, num_instances_, instance_index_);
+}
+
+auto BufferPoolManager::AllocateNewPageId() -> page_id_t {
+  // 每个实例按 num_instances_ 的步长分配页号，这样 page_id % num_instances_ 就能找回所属的实例
+  page_id_t next_page_id;
+  do {
+    next_page_id = next_page_id_.fetch_add(static_cast<page_id_t>(num_instances_));
+  } while (FreePageMap::IsMapPage(next_page_id));  // 空闲页位图占用的页号跳过
+  BUSTUB_ASSERT(static_cast<uint32_t>(next_page_id) % num_instances_ == instance_index_,
+                "allocated pages must mod back to this BPI");
+  return next_page_id;
+}
+
+auto BufferPoolManager::IsAllocatedPageId(page_id_t page_id) const -> bool {
+  return page_id >= 0 && page_id < next_page_id_.load() &&
+         static_cast<uint32_t>(page_id) % num_instances_ == instance_index_ && !FreePageMap::IsMapPage(page_id);
+}
+
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id, AccessType access_type) -> BasicPageGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
+
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, AccessType access_type) -> ReadPageGuard {
+  auto page = FetchPage(page_id, access_type);
   page->RLatch();       // 读共享锁
   return {this, page};  // 调用另外的一种构造函数
 }
 
-auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard {
-  auto page = FetchPage(page_id);
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id, AccessType access_type) -> OptimisticReadGuard {
+  return {this, FetchPage(page_id, access_type)};
+}
+
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id, AccessType access_type) -> WritePageGuard {
+  auto page = FetchPage(page_id, access_type);
   page->WLatch();       // 读共享锁
   return {this, page};  // 调用另外的一种构造函数
 }
 // 这样读和写的时候就调用这两个接口就行了，并且还加了锁，还可以用类自己创建的Drop进行释放
 
-auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {this, NewPage(page_id)}; }
+auto BufferPoolManager::FetchPagesBasic(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> std::vector<BasicPageGuard> {
+  std::vector<BasicPageGuard> guards;
+  guards.reserve(page_ids.size());
+  for (auto *page : FetchPages(page_ids, access_type)) {
+    guards.emplace_back(this, page);
+  }
+  return guards;
+}
+
+auto BufferPoolManager::FetchPagesRead(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> std::vector<ReadPageGuard> {
+  std::vector<ReadPageGuard> guards;
+  guards.reserve(page_ids.size());
+  for (auto *page : FetchPages(page_ids, access_type)) {
+    if (page != nullptr) {
+      page->RLatch();
+    }
+    guards.emplace_back(this, page);
+  }
+  return guards;
+}
+
+auto BufferPoolManager::FetchPagesWrite(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> std::vector<WritePageGuard> {
+  std::vector<WritePageGuard> guards;
+  guards.reserve(page_ids.size());
+  for (auto *page : FetchPages(page_ids, access_type)) {
+    if (page != nullptr) {
+      page->WLatch();
+    }
+    guards.emplace_back(this, page);
+  }
+  return guards;
+}
+
+auto BufferPoolManager::DropStalePage(page_id_t page_id) -> bool {
+  frame_id_t frame_id;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    return true;
+  }
+  // 和DeletePage一样，只是页号已经重新分配出去了，不用再释放
+  auto &page = GetFrame(frame_id);
+  int unpinned = 0;
+  if (!page.pin_count_.compare_exchange_strong(unpinned, -1)) {
+    return false;
+  }
+  page.page_id_ = INVALID_PAGE_ID;
+  page.ResetMemory();
+  page.is_dirty_ = false;
+  page_table_.Erase(page_id);
+  ForgetFrame(frame_id);
+  free_list_.push_back(frame_id);
+  return true;
+}
+
+void BufferPoolManager::DeallocatePage(page_id_t page_id) { disk_manager_->GetFreePageMap()->Free(page_id); }
+
+auto BufferPoolManager::NewPageGuarded(page_id_t *page_id, page_id_t hint) -> BasicPageGuard {
+  return {this, NewPage(page_id, hint)};
+}
+
+auto BufferPoolManager::NewPagesGuarded(size_t num_pages, std::vector<page_id_t> *page_ids, page_id_t hint)
+    -> std::vector<BasicPageGuard> {
+  std::vector<BasicPageGuard> guards;
+  for (auto *page : NewPages(num_pages, page_ids, hint)) {
+    guards.emplace_back(this, page);
+  }
+  return guards;
+}
 
 }  // namespace bustub
 /*
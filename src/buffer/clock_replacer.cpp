@@ -12,18 +12,122 @@
 
 #include "buffer/clock_replacer.h"
 
+#include "common/exception.h"
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_frames_(num_pages + 1),
+      is_tracked_(num_pages + 1),
+      is_evictable_(num_pages + 1),
+      ref_(num_pages + 1) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  // 最多转两圈：第一圈把引用位清掉，第二圈一定能找到
+  while (true) {
+    const size_t frame = hand_;
+    hand_ = hand_ + 1 == num_frames_ ? 0 : hand_ + 1;
+    if (!is_evictable_[frame]) {
+      continue;
+    }
+    if (ref_[frame]) {
+      ref_[frame] = false;
+      continue;
+    }
+    *frame_id = static_cast<frame_id_t>(frame);
+    is_tracked_[frame] = false;
+    is_evictable_[frame] = false;
+    curr_size_--;
+    return true;
+  }
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range");
+  }
+  if (!is_tracked_[frame_id]) {
+    is_tracked_[frame_id] = true;
+    ref_[frame_id] = false;
+  }
+  if (access_type != AccessType::Scan && access_type != AccessType::Prefetch) {
+    ref_[frame_id] = true;
+  }
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range");
+  }
+  if (!is_tracked_[frame_id] || is_evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  is_evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_ || !is_evictable_[frame_id]) {
+    return;
+  }
+  is_tracked_[frame_id] = false;
+  is_evictable_[frame_id] = false;
+  curr_size_--;
+}
+
+auto ClockReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return curr_size_;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+auto ClockReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<frame_id_t> candidates;
+  // 从指针的位置开始，先取引用位为0的帧，再取引用位为1的帧
+  for (bool ref : {false, true}) {
+    for (size_t i = 0; i < num_frames_ && candidates.size() < max_frames; i++) {
+      const size_t frame = (hand_ + i) % num_frames_;
+      if (is_evictable_[frame] && ref_[frame] == ref) {
+        candidates.push_back(static_cast<frame_id_t>(frame));
+      }
+    }
+  }
+  return candidates;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_ && is_evictable_[frame_id]) {
+      return;
+    }
+  }
+  RecordAccess(frame_id);
+  SetEvictable(frame_id, true);
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Resize(size_t num_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (num_frames + 1 <= num_frames_) {
+    return;
+  }
+  num_frames_ = num_frames + 1;
+  is_tracked_.resize(num_frames_);
+  is_evictable_.resize(num_frames_);
+  ref_.resize(num_frames_);
+}
 
 }  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+namespace {
+
+/** Size of a huge page on x86-64 and aarch64 with 4 KiB base pages. */
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+}  // namespace
+
+FrameArena::FrameArena(size_t num_frames, FrameLayout layout) {
+  BUSTUB_ASSERT(layout != FrameLayout::PerPage, "a frame arena needs an arena layout");
+  size_ = num_frames * BUSTUB_PAGE_SIZE;
+  void *data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (layout == FrameLayout::HugeTlbArena) {
+    // MAP_HUGETLB要求长度是大页的整数倍
+    const size_t huge_size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    data = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      size_ = huge_size;
+      huge_tlb_ = true;
+    }
+  }
+#endif
+  if (data == MAP_FAILED) {
+    data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the frames of the buffer pool");
+    }
+#ifdef MADV_HUGEPAGE
+    // 只是建议，内核不支持透明大页时忽略错误
+    if (size_ >= HUGE_PAGE_SIZE) {
+      madvise(data, size_, MADV_HUGEPAGE);
+    }
+#endif
+  }
+  data_ = static_cast<char *>(data);
+}
+
+FrameArena::~FrameArena() { munmap(data_, size_); }
+
+void FrameArena::Release(size_t first_frame, size_t num_frames) {
+  // 只是建议，失败的话内存留着也不影响正确性；大页的映射释放不了小于一个大页的部分
+  madvise(GetFrame(first_frame), num_frames * BUSTUB_PAGE_SIZE, MADV_DONTNEED);
+}
+
+}  // namespace bustub
@@ -11,151 +11,242 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/lru_k_replacer.h"
+
+#include <queue>
+#include <utility>
+
 #include "common/exception.h"
 
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {
-  is_accessible_.resize(num_frames + 1);  // +1是因为帧是从1开始编号的,帧的个数
-  curr_size_ = 0;                         // 可以淘汰的数量
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : replacer_size_(num_frames),
+      k_(k),
+      // +1是因为帧号可以等于num_frames
+      history_((num_frames + 1) * k),
+      history_head_(num_frames + 1),
+      access_count_(num_frames + 1),
+      is_evictable_(num_frames + 1),
+      is_cold_(num_frames + 1),
+      is_prefetched_(num_frames + 1),
+      heap_pos_(num_frames + 1, NOT_IN_HEAP) {
+  BUSTUB_ASSERT(k > 0, "k must be positive");
+  heap_.reserve(num_frames + 1);
 }
-// 淘汰函数
+// 淘汰函数，堆顶就是后向k距离最大的可淘汰帧
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::lock_guard<std::mutex> guard(latch_);
-  *frame_id = 0;
-  // 如果队列中就没有就不可能删除了
-  if (history_map_.empty() && cache_map_.empty()) {
+  if (heap_.empty()) {
+    failed_evictions_.Add();
     return false;
   }
-  // 优先淘汰队列，历史队列FIFO,优先淘汰末尾的数据，如果整个历史队列都找不到一个可以淘汰的就进入到缓存队列
-  auto it = history_list_.end();
-  while (it != history_list_.begin()) {
-    it--;
-    // 如果还没有被列为可驱逐
-    if (!is_accessible_[*it]) {
-      continue;
-    }
-    // 如果被列为了可驱逐
-    *frame_id = *it;
-    history_map_.erase(*it);
-    use_count_[*it] = 0;
-    curr_size_--;
-    is_accessible_[*it] = false;
-    history_list_.erase(it);
-    return true;
-  }
-  // 如果不在历史队列中，在缓存队列中，就遵循LRU-K进行淘汰
-  it = cache_list_.end();
-  while (it != cache_list_.begin()) {
-    it--;
-    // 如果还没有被列为可驱逐
-    if (!is_accessible_[*it]) {
-      continue;
-    }
-    // 如果被列为了可驱逐
-    *frame_id = *it;
-    cache_map_.erase(*it);
-    use_count_[*it] = 0;
-    curr_size_--;
-    is_accessible_[*it] = false;
-    cache_list_.erase(it);
-    return true;
-  }
-  return false;
+  *frame_id = heap_.front();
+  evictions_.Add();
+  if (is_cold_[*frame_id]) {
+    cold_evictions_.Add();
+  } else if (is_prefetched_[*frame_id]) {
+    unused_prefetch_evictions_.Add();
+  } else if (access_count_[*frame_id] < k_) {
+    evictions_below_k_.Add();
+  }
+  HeapErase(*frame_id);
+  is_evictable_[*frame_id] = false;
+  is_cold_[*frame_id] = false;
+  is_prefetched_[*frame_id] = false;
+  ClearHistory(*frame_id);
+  return true;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id, [[maybe_unused]] AccessType access_type) {
-  // 等于k把编号从历史队列删除加到缓存队列中，大于k就刷新一次，把他加到缓存队列的最前面，小于k除了第一次创建时候把他加到表头其他不变
-  // 在缓存队列中访问了就把他提到最前面，在历史队列中访问了只增加计数，不需要提取到最前面
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
   std::lock_guard<std::mutex> guard(latch_);
   // 边界异常,编号比帧的数量还要大就抛出异常
-  if (frame_id > static_cast<int>(replacer_size_)) {
+  if (frame_id < 0 || frame_id > static_cast<int>(replacer_size_)) {
     throw std::exception();
   }
-  // 访问计数加一
-  use_count_[frame_id]++;
-  // 访问频次等于k就加到缓存队列中
-  if (use_count_[frame_id] == k_) {
-    // 如果在历史队列中
-    if (history_map_.count(frame_id) != 0U) {
-      auto it = history_map_[frame_id];  // 获取指向list对应元素的指针
-      history_list_.erase(it);           // 历史队列删除这个点}
+  accesses_.Add();
+  if (access_type == AccessType::Prefetch) {
+    // 预读只给没有历史的帧记一次访问，真正用到之前它和只访问过一次的帧一样按LRU淘汰
+    if (access_count_[frame_id] != 0) {
+      return;
     }
-    history_map_.erase(frame_id);  // 前面为什么要加一个判断呢，可能出于安全的考虑吧
-    // 把这个添加到缓存队列中去
-    cache_list_.push_front(frame_id);
-    cache_map_[frame_id] = cache_list_.begin();
-  } else if (use_count_[frame_id] > k_) {
-    // 大于k就重新刷新一下就行
-    if (cache_map_.count(frame_id) != 0U) {
-      auto it = cache_map_[frame_id];
-      cache_list_.erase(it);
-    }
-    cache_map_.erase(frame_id);
-    // 把他加到前面
-    cache_list_.push_front(frame_id);
-    cache_map_[frame_id] = cache_list_.begin();
-  } else {
-    // 自增之后还是小于k次
-    if (history_map_.count(frame_id) == 0U) {
-      history_list_.push_front(frame_id);
-      history_map_[frame_id] = history_list_.begin();
+    is_prefetched_[frame_id] = true;
+  } else if (access_type == AccessType::Scan) {
+    // 热的帧被扫描到了不改变它的历史，否则就是冷帧，只记最近一次扫描的时间
+    if (access_count_[frame_id] != 0 && !is_cold_[frame_id] && !is_prefetched_[frame_id]) {
+      return;
     }
+    is_cold_[frame_id] = true;
+    is_prefetched_[frame_id] = false;
+    ClearHistory(frame_id);
+  } else if (is_cold_[frame_id] || is_prefetched_[frame_id]) {
+    // 冷帧或者预读的帧第一次被正常访问，之前的记录不算数
+    is_cold_[frame_id] = false;
+    is_prefetched_[frame_id] = false;
+    ClearHistory(frame_id);
+  }
+  // 把这次访问的时间戳写到环里，覆盖掉最老的那一次
+  auto &head = history_head_[frame_id];
+  history_[frame_id * k_ + head] = current_timestamp_++;
+  head = head + 1 == k_ ? 0 : head + 1;
+  access_count_[frame_id]++;
+  // 排序的键只会变大，如果在堆里就往下调整
+  if (heap_pos_[frame_id] != NOT_IN_HEAP) {
+    HeapFix(heap_pos_[frame_id]);
   }
 }
 // 设置为可淘汰的函数
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::lock_guard<std::mutex> guard(latch_);
   // 边界异常,编号比帧的数量还要大就抛出异常
-  if (frame_id > static_cast<int>(replacer_size_)) {
+  if (frame_id < 0 || frame_id > static_cast<int>(replacer_size_)) {
     throw std::exception();
   }
-  // 如果之前被设置成不能驱逐，现在想要设置成驱逐就数量相加
-  if (!is_accessible_[frame_id] && set_evictable) {
-    curr_size_++;  // 可以驱逐的数量
+  // 没有访问记录的帧不在替换器里，什么都不做
+  if (access_count_[frame_id] == 0 || is_evictable_[frame_id] == set_evictable) {
+    return;
   }
-  // 如果之前设置成可以驱逐，但是现在要求不能驱逐，数量就剪剪
-  if (is_accessible_[frame_id] && !set_evictable) {
-    curr_size_--;
+  is_evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    HeapPush(frame_id);
+  } else {
+    HeapErase(frame_id);
   }
-  is_accessible_[frame_id] = set_evictable;
-  // 这个api的作用就是设置是否可以被，同时更改被驱逐的数目，判断是为了避免重复计数
 }
 
 // 把一个帧直接删除掉,这个函数就是找到了就把他清除掉
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::lock_guard<std::mutex> guard(latch_);
-  if (!is_accessible_[frame_id]) {
+  if (frame_id < 0 || frame_id > static_cast<int>(replacer_size_)) {
     return;
   }
-  if (frame_id > static_cast<int>(replacer_size_)) {
+  if (!is_evictable_[frame_id]) {
     return;
   }
-  // 删除记录
-  if (use_count_[frame_id] < k_) {
-    auto it = history_map_[frame_id];
-    history_list_.erase(it);
-    history_map_.erase(frame_id);
-  } else {
-    auto it = cache_map_[frame_id];
-    cache_list_.erase(it);
-    cache_map_.erase(frame_id);
-  }
-  // 删除记录
-  use_count_[frame_id] = 0;
-  // 当前可用大小减少
-  is_accessible_[frame_id] = false;
-  curr_size_--;
+  HeapErase(frame_id);
+  is_evictable_[frame_id] = false;
+  is_cold_[frame_id] = false;
+  is_prefetched_[frame_id] = false;
+  ClearHistory(frame_id);
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return heap_.size();
+}
+
+auto LRUKReplacer::GetStats() -> ReplacerStats {
+  ReplacerStats stats;
+  stats.accesses_ = accesses_.Load();
+  stats.evictions_ = evictions_.Load();
+  stats.evictions_below_k_ = evictions_below_k_.Load();
+  stats.cold_evictions_ = cold_evictions_.Load();
+  stats.unused_prefetch_evictions_ = unused_prefetch_evictions_.Load();
+  stats.failed_evictions_ = failed_evictions_.Load();
+  return stats;
+}
+
+auto LRUKReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<frame_id_t> candidates;
+  // 从堆顶开始按淘汰顺序往下找，frontier里放的是还没取出的堆下标，每取出一个就把它的两个孩子放进去
+  auto later = [this](size_t a, size_t b) { return EvictBefore(heap_[b], heap_[a]); };
+  std::priority_queue<size_t, std::vector<size_t>, decltype(later)> frontier(later);
+  if (!heap_.empty()) {
+    frontier.push(0);
+  }
+  while (!frontier.empty() && candidates.size() < max_frames) {
+    const size_t pos = frontier.top();
+    frontier.pop();
+    candidates.push_back(heap_[pos]);
+    for (size_t child = 2 * pos + 1; child <= 2 * pos + 2 && child < heap_.size(); child++) {
+      frontier.push(child);
+    }
+  }
+  return candidates;
 }
 
-auto LRUKReplacer::Size() -> size_t { return curr_size_; }
+void LRUKReplacer::ClearHistory(frame_id_t frame_id) {
+  access_count_[frame_id] = 0;
+  history_head_[frame_id] = 0;
+}
+
+void LRUKReplacer::HeapPush(frame_id_t frame_id) {
+  heap_pos_[frame_id] = heap_.size();
+  heap_.push_back(frame_id);
+  HeapFix(heap_.size() - 1);
+}
+
+void LRUKReplacer::HeapErase(frame_id_t frame_id) {
+  const size_t pos = heap_pos_[frame_id];
+  const size_t last = heap_.size() - 1;
+  if (pos != last) {
+    HeapSwap(pos, last);
+  }
+  heap_.pop_back();
+  heap_pos_[frame_id] = NOT_IN_HEAP;
+  if (pos < heap_.size()) {
+    HeapFix(pos);
+  }
+}
+
+void LRUKReplacer::HeapFix(size_t pos) {
+  // 先往上调整
+  while (pos > 0) {
+    const size_t parent = (pos - 1) / 2;
+    if (!EvictBefore(heap_[pos], heap_[parent])) {
+      break;
+    }
+    HeapSwap(pos, parent);
+    pos = parent;
+  }
+  // 再往下调整
+  while (true) {
+    const size_t left = 2 * pos + 1;
+    const size_t right = left + 1;
+    size_t smallest = pos;
+    if (left < heap_.size() && EvictBefore(heap_[left], heap_[smallest])) {
+      smallest = left;
+    }
+    if (right < heap_.size() && EvictBefore(heap_[right], heap_[smallest])) {
+      smallest = right;
+    }
+    if (smallest == pos) {
+      break;
+    }
+    HeapSwap(pos, smallest);
+    pos = smallest;
+  }
+}
+
+void LRUKReplacer::HeapSwap(size_t a, size_t b) {
+  std::swap(heap_[a], heap_[b]);
+  heap_pos_[heap_[a]] = a;
+  heap_pos_[heap_[b]] = b;
+}
+
+void LRUKReplacer::Resize(size_t num_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  // 数组只变大不变小，缩小的时候多出来的帧已经不在替换器里了
+  if (num_frames <= replacer_size_) {
+    return;
+  }
+  replacer_size_ = num_frames;
+  history_.resize((num_frames + 1) * k_);
+  history_head_.resize(num_frames + 1);
+  access_count_.resize(num_frames + 1);
+  is_evictable_.resize(num_frames + 1);
+  is_cold_.resize(num_frames + 1);
+  is_prefetched_.resize(num_frames + 1);
+  heap_pos_.resize(num_frames + 1, NOT_IN_HEAP);
+  heap_.reserve(num_frames + 1);
+}
 
 }  // namespace bustub
 
 /*
-总的来说，RecordAccess实现了在访问数据的时候历史队列和缓存队列的维护
-SetEvictable(frame_id_t frame_id, bool set_evictable)手动设置某个帧是否可以被驱逐
-Evict(frame_id_t *frame_id)返回一个可以被驱逐的帧id并把他删除，基于规则
+总的来说，RecordAccess把访问时间戳写进每个帧自己的环里，可淘汰的帧按（是否冷帧，是否访问满k次，环里最老的时间戳）放在一个小根堆里
+SetEvictable(frame_id_t frame_id, bool set_evictable)手动设置某个帧是否可以被驱逐，可驱逐的帧在堆里，不可驱逐的不在
+Evict(frame_id_t *frame_id)弹出堆顶，就是后向k距离最大的帧
 Remove只要在并且允许就把他删除，不管他的优先级。
 这里指示操作了index，或者说是页号
 */
@@ -12,18 +12,103 @@
 
 #include "buffer/lru_replacer.h"
 
+#include "common/exception.h"
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages)
+    : num_frames_(num_pages + 1),
+      is_tracked_(num_pages + 1),
+      is_evictable_(num_pages + 1),
+      last_access_(num_pages + 1) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (lru_.empty()) {
+    return false;
+  }
+  *frame_id = lru_.begin()->second;
+  lru_.erase(lru_.begin());
+  is_tracked_[*frame_id] = false;
+  is_evictable_[*frame_id] = false;
+  return true;
+}
+
+void LRUReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range");
+  }
+  is_tracked_[frame_id] = true;
+  if (is_evictable_[frame_id]) {
+    lru_.erase({last_access_[frame_id], frame_id});
+    lru_.emplace(current_timestamp_, frame_id);
+  }
+  last_access_[frame_id] = current_timestamp_++;
+}
+
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range");
+  }
+  if (!is_tracked_[frame_id] || is_evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  is_evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    lru_.emplace(last_access_[frame_id], frame_id);
+  } else {
+    lru_.erase({last_access_[frame_id], frame_id});
+  }
+}
+
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_ || !is_evictable_[frame_id]) {
+    return;
+  }
+  lru_.erase({last_access_[frame_id], frame_id});
+  is_tracked_[frame_id] = false;
+  is_evictable_[frame_id] = false;
+}
+
+auto LRUReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return lru_.size();
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+auto LRUReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<frame_id_t> candidates;
+  for (auto it = lru_.begin(); it != lru_.end() && candidates.size() < max_frames; ++it) {
+    candidates.push_back(it->second);
+  }
+  return candidates;
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+void LRUReplacer::Unpin(frame_id_t frame_id) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (frame_id >= 0 && static_cast<size_t>(frame_id) < num_frames_ && is_evictable_[frame_id]) {
+      return;
+    }
+  }
+  RecordAccess(frame_id);
+  SetEvictable(frame_id, true);
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+void LRUReplacer::Resize(size_t num_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (num_frames + 1 <= num_frames_) {
+    return;
+  }
+  num_frames_ = num_frames + 1;
+  is_tracked_.resize(num_frames_);
+  is_evictable_.resize(num_frames_);
+  last_access_.resize(num_frames_);
+}
 
 }  // namespace bustub
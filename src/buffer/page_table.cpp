@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::Table::Table(size_t capacity)
+    : mask_(capacity - 1), slots_(std::make_unique<std::atomic<uint64_t>[]>(capacity)) {
+  shift_ = 64;
+  for (size_t c = capacity; c > 1; c >>= 1) {
+    shift_--;
+  }
+  for (size_t i = 0; i < capacity; i++) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+PageTable::PageTable(size_t num_frames) {
+  tables_.push_back(std::make_unique<Table>(CapacityFor(num_frames)));
+  table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+PageTable::~PageTable() = default;
+
+auto PageTable::CapacityFor(size_t num_frames) -> size_t {
+  size_t capacity = 16;
+  while (capacity < num_frames * 2) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot map an invalid page id");
+  Table *table = table_.load(std::memory_order_relaxed);
+  size_t i = table->Home(page_id);
+  while (true) {
+    const uint64_t slot = table->slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY || PageIdOf(slot) == page_id) {
+      size_ += slot == EMPTY ? 1 : 0;
+      table->slots_[i].store(MakeSlot(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+    i = (i + 1) & table->mask_;
+  }
+}
+
+void PageTable::Erase(page_id_t page_id) {
+  Table *table = table_.load(std::memory_order_relaxed);
+  size_t hole = table->Home(page_id);
+  while (true) {
+    const uint64_t slot = table->slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      return;
+    }
+    if (PageIdOf(slot) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & table->mask_;
+  }
+  size_--;
+
+  // 后面同一条探测序列上的项往前挪，填上空出来的位置，这样查找遇到空槽就可以停下
+  for (size_t i = (hole + 1) & table->mask_;; i = (i + 1) & table->mask_) {
+    const uint64_t slot = table->slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      break;
+    }
+    // 这一项的起始位置在(hole, i]之间的话，挪到hole之后就找不到它了，留在原地
+    const size_t home = table->Home(PageIdOf(slot));
+    const bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (!stays) {
+      table->slots_[hole].store(slot, std::memory_order_release);
+      hole = i;
+    }
+  }
+  table->slots_[hole].store(EMPTY, std::memory_order_release);
+}
+
+void PageTable::Reserve(size_t num_frames) {
+  Table *table = table_.load(std::memory_order_relaxed);
+  const size_t capacity = CapacityFor(num_frames);
+  if (capacity <= table->mask_ + 1) {
+    return;
+  }
+  auto new_table = std::make_unique<Table>(capacity);
+  for (size_t i = 0; i <= table->mask_; i++) {
+    const uint64_t slot = table->slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      continue;
+    }
+    size_t j = new_table->Home(PageIdOf(slot));
+    while (new_table->slots_[j].load(std::memory_order_relaxed) != EMPTY) {
+      j = (j + 1) & new_table->mask_;
+    }
+    new_table->slots_[j].store(slot, std::memory_order_relaxed);
+  }
+  // 旧表上可能还有读者在找，不能释放
+  tables_.push_back(std::move(new_table));
+  table_.store(tables_.back().get(), std::memory_order_release);
+}
+
+}  // namespace bustub
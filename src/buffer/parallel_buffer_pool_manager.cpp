@@ -0,0 +1,213 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <vector>
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerType replacer_type) {
+  BUSTUB_ASSERT(num_instances > 0, "a parallel buffer pool needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManager>(pool_size, static_cast<uint32_t>(num_instances),
+                                                                static_cast<uint32_t>(i), disk_manager, replacer_k,
+                                                                log_manager, replacer_type));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  // 预读线程会调用本类的FetchPage，要在销毁各个实例之前停掉
+  StopPrefetch();
+}
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::Resize(size_t new_size) -> bool {
+  if (new_size < instances_.size()) {
+    return false;
+  }
+  bool resized = true;
+  for (size_t i = 0; i < instances_.size(); i++) {
+    const size_t instance_size = new_size / instances_.size() + (i < new_size % instances_.size() ? 1 : 0);
+    resized = instances_[i]->Resize(instance_size) && resized;
+  }
+  return resized;
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager * {
+  BUSTUB_ASSERT(page_id >= 0, "invalid page id");
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+auto ParallelBufferPoolManager::NewPage(page_id_t *page_id, page_id_t hint) -> Page * {
+  // Start from a different instance every call so that new pages are spread evenly over the instances, and give up
+  // only after every instance has been asked once.
+  const size_t start = next_instance_.fetch_add(1) % instances_.size();
+  for (size_t i = 0; i < instances_.size(); i++) {
+    auto *page = instances_[(start + i) % instances_.size()]->NewPage(page_id, hint);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::FetchPage(page_id_t page_id, AccessType access_type) -> Page * {
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  return GetBufferPoolManager(page_id)->FetchPage(page_id, access_type);
+}
+
+auto ParallelBufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type)
+    -> std::vector<Page *> {
+  // 按实例分组，每个实例一批，再按原来的顺序放回去
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  std::vector<std::vector<size_t>> instance_positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    if (page_ids[i] != INVALID_PAGE_ID) {
+      const size_t instance = static_cast<size_t>(page_ids[i]) % instances_.size();
+      instance_page_ids[instance].push_back(page_ids[i]);
+      instance_positions[instance].push_back(i);
+    }
+  }
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  for (size_t instance = 0; instance < instances_.size(); instance++) {
+    if (instance_page_ids[instance].empty()) {
+      continue;
+    }
+    auto instance_pages = instances_[instance]->FetchPages(instance_page_ids[instance], access_type);
+    for (size_t i = 0; i < instance_pages.size(); i++) {
+      pages[instance_positions[instance][i]] = instance_pages[i];
+    }
+  }
+  return pages;
+}
+
+auto ParallelBufferPoolManager::NewPages(size_t num_pages, std::vector<page_id_t> *page_ids, page_id_t hint)
+    -> std::vector<Page *> {
+  // Like NewPage(), but an instance is asked for all the pages that are still missing, so that a batch usually comes
+  // from a single instance.
+  std::vector<Page *> pages;
+  page_ids->clear();
+  const size_t start = next_instance_.fetch_add(1) % instances_.size();
+  for (size_t i = 0; i < instances_.size() && pages.size() < num_pages; i++) {
+    std::vector<page_id_t> instance_page_ids;
+    auto instance_pages =
+        instances_[(start + i) % instances_.size()]->NewPages(num_pages - pages.size(), &instance_page_ids, hint);
+    pages.insert(pages.end(), instance_pages.begin(), instance_pages.end());
+    page_ids->insert(page_ids->end(), instance_page_ids.begin(), instance_page_ids.end());
+  }
+  return pages;
+}
+
+auto ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty, access_type);
+}
+
+auto ParallelBufferPoolManager::FlushPage(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+  // 相邻的页在不同的实例里，所有实例的脏页一起写才能合并
+  instances_[0]->disk_manager_->GetFreePageMap()->Flush();
+  std::vector<Page *> pages;
+  for (auto &instance : instances_) {
+    instance->PinDirtyPages(&pages);
+  }
+  WriteDirtyPages(instances_[0]->disk_manager_, pages);
+}
+
+auto ParallelBufferPoolManager::DeletePage(page_id_t page_id) -> bool {
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::StartBackgroundWriter(size_t batch_size, std::chrono::milliseconds interval) {
+  for (auto &instance : instances_) {
+    instance->StartBackgroundWriter(batch_size, interval);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundWriter() {
+  for (auto &instance : instances_) {
+    instance->StopBackgroundWriter();
+  }
+}
+
+auto ParallelBufferPoolManager::GetForegroundWriteCount() -> size_t {
+  size_t count = 0;
+  for (auto &instance : instances_) {
+    count += instance->GetForegroundWriteCount();
+  }
+  return count;
+}
+
+auto ParallelBufferPoolManager::GetBackgroundWriteCount() -> size_t {
+  size_t count = 0;
+  for (auto &instance : instances_) {
+    count += instance->GetBackgroundWriteCount();
+  }
+  return count;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats total;
+  for (auto &instance : instances_) {
+    const auto stats = instance->GetStats();
+    total.pool_size_ += stats.pool_size_;
+    total.free_frames_ += stats.free_frames_;
+    total.pinned_frames_ += stats.pinned_frames_;
+    total.hits_ += stats.hits_;
+    total.misses_ += stats.misses_;
+    total.prefetch_reads_ += stats.prefetch_reads_;
+    total.new_pages_ += stats.new_pages_;
+    total.evictions_ += stats.evictions_;
+    total.all_pinned_ += stats.all_pinned_;
+    total.dirty_write_backs_ += stats.dirty_write_backs_;
+    total.background_write_backs_ += stats.background_write_backs_;
+    total.pin_waits_ += stats.pin_waits_;
+    total.latch_acquisitions_ += stats.latch_acquisitions_;
+    total.latch_hold_ns_ += stats.latch_hold_ns_;
+    total.replacer_.accesses_ += stats.replacer_.accesses_;
+    total.replacer_.evictions_ += stats.replacer_.evictions_;
+    total.replacer_.evictions_below_k_ += stats.replacer_.evictions_below_k_;
+    total.replacer_.cold_evictions_ += stats.replacer_.cold_evictions_;
+    total.replacer_.unused_prefetch_evictions_ += stats.replacer_.unused_prefetch_evictions_;
+    total.replacer_.failed_evictions_ += stats.replacer_.failed_evictions_;
+  }
+  return total;
+}
+
+}  // namespace bustub
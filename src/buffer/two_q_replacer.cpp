@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.cpp
+//
+// Identification: src/buffer/two_q_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_q_replacer.h"
+
+#include <algorithm>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+TwoQReplacer::TwoQReplacer(size_t num_frames)
+    : num_frames_(num_frames + 1),
+      // 论文推荐Kin为缓冲池的25%，Kout为50%
+      kin_(std::max<size_t>(num_frames / 4, 1)),
+      kout_(std::max<size_t>(num_frames / 2, 1)),
+      queue_(num_frames + 1, Queue::None),
+      is_evictable_(num_frames + 1),
+      timestamp_(num_frames + 1),
+      page_id_(num_frames + 1, INVALID_PAGE_ID) {}
+
+void TwoQReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "frame id out of range");
+  }
+}
+
+auto TwoQReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (a1in_.empty() && am_.empty()) {
+    return false;
+  }
+  const bool from_a1in = PreferA1in();
+  auto &set = from_a1in ? a1in_ : am_;
+  *frame_id = set.begin()->second;
+  Untrack(*frame_id, from_a1in);
+  return true;
+}
+
+void TwoQReplacer::RecordAccess(frame_id_t frame_id, AccessType access_type) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  const size_t now = current_timestamp_++;
+  if (queue_[frame_id] == Queue::A1in) {
+    // A1in里的再次访问被看作相关访问，不移动
+    return;
+  }
+  if (queue_[frame_id] == Queue::Am) {
+    if (is_evictable_[frame_id]) {
+      am_.erase({timestamp_[frame_id], frame_id});
+      am_.emplace(now, frame_id);
+    }
+    timestamp_[frame_id] = now;
+    return;
+  }
+  // 新载入的页：在A1out里的进入Am，否则进入A1in
+  auto it = a1out_map_.find(page_id_[frame_id]);
+  if (it != a1out_map_.end() && access_type != AccessType::Prefetch) {
+    a1out_.erase(it->second);
+    a1out_map_.erase(it);
+    queue_[frame_id] = Queue::Am;
+  } else {
+    queue_[frame_id] = Queue::A1in;
+    a1in_size_++;
+  }
+  is_evictable_[frame_id] = false;
+  timestamp_[frame_id] = now;
+}
+
+void TwoQReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  if (queue_[frame_id] == Queue::None || is_evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  is_evictable_[frame_id] = set_evictable;
+  auto &set = EvictableSet(queue_[frame_id]);
+  if (set_evictable) {
+    set.emplace(timestamp_[frame_id], frame_id);
+  } else {
+    set.erase({timestamp_[frame_id], frame_id});
+  }
+}
+
+void TwoQReplacer::Remove(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= num_frames_ || !is_evictable_[frame_id]) {
+    return;
+  }
+  Untrack(frame_id, false);
+}
+
+auto TwoQReplacer::Size() -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return a1in_.size() + am_.size();
+}
+
+auto TwoQReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::vector<frame_id_t> candidates;
+  const auto &first = PreferA1in() ? a1in_ : am_;
+  const auto &second = PreferA1in() ? am_ : a1in_;
+  for (const auto *set : {&first, &second}) {
+    for (auto it = set->begin(); it != set->end() && candidates.size() < max_frames; ++it) {
+      candidates.push_back(it->second);
+    }
+  }
+  return candidates;
+}
+
+void TwoQReplacer::SetPageId(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  CheckFrameId(frame_id);
+  page_id_[frame_id] = page_id;
+}
+
+void TwoQReplacer::Untrack(frame_id_t frame_id, bool remember) {
+  EvictableSet(queue_[frame_id]).erase({timestamp_[frame_id], frame_id});
+  if (queue_[frame_id] == Queue::A1in) {
+    a1in_size_--;
+  }
+  queue_[frame_id] = Queue::None;
+  is_evictable_[frame_id] = false;
+
+  const page_id_t page_id = page_id_[frame_id];
+  page_id_[frame_id] = INVALID_PAGE_ID;
+  if (!remember || page_id == INVALID_PAGE_ID || a1out_map_.count(page_id) != 0) {
+    return;
+  }
+  a1out_.push_front(page_id);
+  a1out_map_.emplace(page_id, a1out_.begin());
+  if (a1out_.size() > kout_) {
+    a1out_map_.erase(a1out_.back());
+    a1out_.pop_back();
+  }
+}
+
+void TwoQReplacer::Resize(size_t num_frames) {
+  std::lock_guard<std::mutex> guard(latch_);
+  kin_ = std::max<size_t>(num_frames / 4, 1);
+  kout_ = std::max<size_t>(num_frames / 2, 1);
+  while (a1out_.size() > kout_) {
+    a1out_map_.erase(a1out_.back());
+    a1out_.pop_back();
+  }
+  if (num_frames + 1 <= num_frames_) {
+    return;
+  }
+  num_frames_ = num_frames + 1;
+  queue_.resize(num_frames_, Queue::None);
+  is_evictable_.resize(num_frames_);
+  timestamp_.resize(num_frames_);
+  page_id_.resize(num_frames_, INVALID_PAGE_ID);
+}
+
+}  // namespace bustub
@@ -2,6 +2,8 @@
 #include <shared_mutex>
 #include <string>
 #include <tuple>
+#include <utility>
+#include <vector>
 
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
@@ -34,6 +36,7 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_posix.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -46,7 +49,7 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  disk_manager_ = new DiskManagerPosix(db_file_name);
 
   // Log related.
   log_manager_ = new LogManager(disk_manager_);
@@ -163,6 +166,55 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayBufferPool(ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    throw Exception("buffer pool manager is not available");
+  }
+  const auto stats = buffer_pool_manager_->GetStats();
+  const auto disk_stats = disk_manager_->GetStats();
+  const auto lookups = stats.hits_ + stats.misses_;
+  const std::vector<std::pair<std::string, std::string>> rows{
+      {"pool_size", fmt::format("{}", stats.pool_size_)},
+      {"free_frames", fmt::format("{}", stats.free_frames_)},
+      {"pinned_frames", fmt::format("{}", stats.pinned_frames_)},
+      {"hits", fmt::format("{}", stats.hits_)},
+      {"misses", fmt::format("{}", stats.misses_)},
+      {"hit_ratio", lookups == 0 ? "-" : fmt::format("{:.4f}", static_cast<double>(stats.hits_) / lookups)},
+      {"prefetch_reads", fmt::format("{}", stats.prefetch_reads_)},
+      {"new_pages", fmt::format("{}", stats.new_pages_)},
+      {"evictions", fmt::format("{}", stats.evictions_)},
+      {"all_pinned", fmt::format("{}", stats.all_pinned_)},
+      {"dirty_write_backs", fmt::format("{}", stats.dirty_write_backs_)},
+      {"background_write_backs", fmt::format("{}", stats.background_write_backs_)},
+      {"pin_waits", fmt::format("{}", stats.pin_waits_)},
+      {"latch_acquisitions", fmt::format("{}", stats.latch_acquisitions_)},
+      {"latch_hold_ms", fmt::format("{:.3f}", static_cast<double>(stats.latch_hold_ns_) / 1e6)},
+      {"replacer_accesses", fmt::format("{}", stats.replacer_.accesses_)},
+      {"replacer_evictions", fmt::format("{}", stats.replacer_.evictions_)},
+      {"replacer_evictions_below_k", fmt::format("{}", stats.replacer_.evictions_below_k_)},
+      {"replacer_cold_evictions", fmt::format("{}", stats.replacer_.cold_evictions_)},
+      {"replacer_unused_prefetch_evictions", fmt::format("{}", stats.replacer_.unused_prefetch_evictions_)},
+      {"replacer_failed_evictions", fmt::format("{}", stats.replacer_.failed_evictions_)},
+      {"disk_pages_written", fmt::format("{}", disk_stats.pages_written_)},
+      {"disk_write_calls", fmt::format("{}", disk_stats.write_calls_)},
+      {"disk_syncs", fmt::format("{}", disk_stats.syncs_)},
+      {"disk_pages_per_sec", fmt::format("{:.1f}", disk_stats.PagesPerSecond())},
+      {"disk_bytes_per_sec", fmt::format("{:.1f}", disk_stats.BytesPerSecond())},
+  };
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("stat");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  for (const auto &[name, value] : rows) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(value);
+    writer.EndRow();
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -176,6 +228,7 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 
 \dt: show all tables
 \di: show all indices
+\bpm: show buffer pool statistics
 \help: show this message again
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
@@ -216,6 +269,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       CmdDisplayIndices(writer);
       return true;
     }
+    if (sql == "\\bpm") {
+      CmdDisplayBufferPool(writer);
+      return true;
+    }
     if (sql == "\\help") {
       CmdDisplayHelp(writer);
       return true;
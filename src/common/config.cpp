@@ -18,6 +18,24 @@ std::atomic<bool> enable_logging(false);
 
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
+std::atomic<size_t> scan_read_ahead_pages(8);
+
+// gcc defines __SANITIZE_ADDRESS__, clang only has __has_feature(address_sanitizer)
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define BUSTUB_ASAN_ENABLED
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define BUSTUB_ASAN_ENABLED
+#endif
+
+#ifdef BUSTUB_ASAN_ENABLED
+std::atomic<FrameLayout> buffer_pool_frame_layout(FrameLayout::PerPage);
+#else
+std::atomic<FrameLayout> buffer_pool_frame_layout(FrameLayout::Arena);
+#endif
+
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
 }  // namespace bustub
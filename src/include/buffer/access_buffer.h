@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// access_buffer.h
+//
+// Identification: src/include/buffer/access_buffer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * AccessBuffer collects the page accesses of buffer pool hits, so that they can be handed to the replacer later, in a
+ * batch, by a thread that holds the buffer pool latch anyway.
+ *
+ * Every thread pushes into one of NUM_STRIPES small rings, picked round robin like the slots of a StatCounter, so
+ * pushing is one compare-and-swap on a mostly uncontended cache line. When the ring of a thread is full the access is
+ * dropped: the replacer only needs an approximate history of hot pages, and a page that is hit often enough is
+ * recorded again soon after.
+ */
+class AccessBuffer {
+ public:
+  static constexpr size_t NUM_STRIPES = 16;
+  static constexpr size_t STRIPE_SIZE = 64;
+
+  /** @brief Record an access of a page, or drop it if the ring of the calling thread is full. */
+  void Push(page_id_t page_id, AccessType access_type) {
+    auto &stripe = stripes_[Stripe()];
+    uint64_t tail = stripe.tail_.load(std::memory_order_relaxed);
+    do {
+      if (tail - stripe.head_.load(std::memory_order_acquire) >= STRIPE_SIZE) {
+        return;
+      }
+    } while (!stripe.tail_.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed));
+    stripe.slots_[tail % STRIPE_SIZE].store(Encode(page_id, access_type), std::memory_order_release);
+  }
+
+  /**
+   * @brief Hand every recorded access to fn(page_id, access_type) and remove it, oldest first within a ring. Only one
+   * thread may drain at a time.
+   */
+  template <typename Fn>
+  void Drain(Fn &&fn) {
+    for (auto &stripe : stripes_) {
+      uint64_t head = stripe.head_.load(std::memory_order_relaxed);
+      const uint64_t tail = stripe.tail_.load(std::memory_order_acquire);
+      for (; head != tail; head++) {
+        // 位置已经被占了但是还没写进来的话，留到下一次
+        const uint64_t entry = stripe.slots_[head % STRIPE_SIZE].exchange(0, std::memory_order_acquire);
+        if (entry == 0) {
+          break;
+        }
+        fn(static_cast<page_id_t>(entry >> 8), static_cast<AccessType>(entry & 0xff));
+      }
+      stripe.head_.store(head, std::memory_order_release);
+    }
+  }
+
+ private:
+  /** Encodes an access as a non-zero word, 0 marks an empty slot. */
+  static auto Encode(page_id_t page_id, AccessType access_type) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 8) | static_cast<uint64_t>(access_type) |
+           (static_cast<uint64_t>(1) << 63);
+  }
+
+  static auto Stripe() -> size_t {
+    static std::atomic<size_t> next_stripe{0};
+    thread_local const size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % NUM_STRIPES;
+    return stripe;
+  }
+
+  struct alignas(64) Ring {
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> tail_{0};
+    std::array<std::atomic<uint64_t>, STRIPE_SIZE> slots_{};
+  };
+
+  std::array<Ring, NUM_STRIPES> stripes_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ArcReplacer implements the Adaptive Replacement Cache policy (Megiddo and Modha, FAST 2003).
+ *
+ * Resident pages are split into T1, pages accessed once since they were loaded, and T2, pages accessed at least twice.
+ * Both are LRU lists. The ghost lists B1 and B2 remember the page ids recently evicted from T1 and T2. A miss on a
+ * page remembered in B1 means T1 was too small, so the target size p of T1 grows; a miss on a page remembered in B2
+ * shrinks it. Victims come from T1 while T1 holds more than p frames, and from T2 otherwise.
+ *
+ * Scan and prefetch accesses of a frame in T1 only refresh its position, they never promote it to T2, so the repeated
+ * accesses of a scan to the same page do not make the page look frequently used.
+ *
+ * The replacer learns the page held by a frame through SetPageId(). Frames whose page id is unknown start in T1.
+ */
+class ArcReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new ArcReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ArcReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ArcReplacer);
+
+  ~ArcReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @brief Make room for frame ids up to num_frames and make it the capacity, see Replacer::Resize(). */
+  void Resize(size_t num_frames) override;
+
+  void SetPageId(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  enum class List { None = 0, T1, T2 };
+
+  /** LRU list of page ids, most recent at the front, with an index for O(1) lookup. */
+  struct GhostList {
+    std::list<page_id_t> list_;
+    std::unordered_map<page_id_t, std::list<page_id_t>::iterator> map_;
+
+    auto Size() const -> size_t { return list_.size(); }
+    auto Contains(page_id_t page_id) const -> bool { return map_.count(page_id) != 0; }
+    void PushFront(page_id_t page_id) {
+      list_.push_front(page_id);
+      map_.emplace(page_id, list_.begin());
+    }
+    void Erase(page_id_t page_id) {
+      auto it = map_.find(page_id);
+      list_.erase(it->second);
+      map_.erase(it);
+    }
+    void PopBack() {
+      map_.erase(list_.back());
+      list_.pop_back();
+    }
+  };
+
+  /** @return the set of evictable frames of the given list. Caller must hold latch_. */
+  auto EvictableSet(List list) -> std::set<std::pair<size_t, frame_id_t>> & { return list == List::T1 ? t1_ : t2_; }
+
+  /** @return true if the next victim should come from T1. Caller must hold latch_. */
+  auto PreferT1() const -> bool { return t2_.empty() || (!t1_.empty() && t1_size_ > p_); }
+
+  /** Stop tracking a frame, remembering its page in B1 or B2 if it was evicted. Caller must hold latch_. */
+  void Untrack(frame_id_t frame_id, bool remember);
+
+  /** Drop the oldest ghost entries until the directory is at most twice the cache size. Caller must hold latch_. */
+  void TrimGhosts();
+
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  std::mutex latch_;
+  size_t num_frames_;
+  /** The cache size c of the paper. */
+  size_t capacity_;
+  /** Target size of T1, adapted on every ghost hit. */
+  size_t p_{0};
+  size_t current_timestamp_{0};
+  /** Number of frames in T1 and T2, evictable or not. */
+  size_t t1_size_{0};
+  size_t t2_size_{0};
+
+  // 下面的数组都按帧号索引
+  std::vector<List> list_;
+  std::vector<bool> is_evictable_;
+  std::vector<size_t> last_access_;
+  std::vector<page_id_t> page_id_;
+
+  /** Evictable frames of T1 and T2, ordered by last access. */
+  std::set<std::pair<size_t, frame_id_t>> t1_;
+  std::set<std::pair<size_t, frame_id_t>> t2_;
+
+  GhostList b1_;
+  GhostList b2_;
+};
+
+}  // namespace bustub
@@ -12,22 +12,77 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
-#include "buffer/lru_k_replacer.h"
+#include "buffer/access_buffer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/stats.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 #include "storage/page/page_guard.h"
 
 namespace bustub {
 
+/** Counters and current state of a buffer pool, see BufferPoolManager::GetStats(). */
+struct BufferPoolStats {
+  /** Number of frames. */
+  uint64_t pool_size_{0};
+  /** Number of frames on the free list. */
+  uint64_t free_frames_{0};
+  /** Number of frames holding a pinned page. */
+  uint64_t pinned_frames_{0};
+  /** Number of fetches that found the page in the buffer pool. Prefetches are not counted. */
+  uint64_t hits_{0};
+  /** Number of fetches that read the page from disk. Prefetches are not counted. */
+  uint64_t misses_{0};
+  /** Number of pages read from disk by prefetches. */
+  uint64_t prefetch_reads_{0};
+  /** Number of pages created. */
+  uint64_t new_pages_{0};
+  /** Number of pages evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Number of times a page could not be fetched or created because every frame was pinned. */
+  uint64_t all_pinned_{0};
+  /** Number of dirty pages written back on the eviction path. */
+  uint64_t dirty_write_backs_{0};
+  /** Number of dirty pages written back by the background writer. */
+  uint64_t background_write_backs_{0};
+  /** Number of fetches that had to wait for disk I/O of another thread on the same page. */
+  uint64_t pin_waits_{0};
+  /** Number of times the buffer pool latch was acquired. Hits of resident pages do not take the latch. */
+  uint64_t latch_acquisitions_{0};
+  /** Total time the buffer pool latch was held, in nanoseconds. */
+  uint64_t latch_hold_ns_{0};
+  /** Counters of the replacer. */
+  ReplacerStats replacer_;
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
+ *
+ * Fetching and unpinning a page that is already in the buffer pool takes no lock: the page is looked up in a
+ * lock-free PageTable and pinned by incrementing its atomic pin count, and the access is handed to the replacer later
+ * through an AccessBuffer. The latch is only taken for misses, new pages, eviction and the other book-keeping.
+ *
+ * The replacer therefore sees pins late. A frame that is not pinned when the replacer is told about its access stays
+ * evictable in the replacer even if it is pinned later, so the eviction path claims a victim by swapping its pin count
+ * from 0 to -1, which fails if a hit pinned it in the meantime. Such a frame, and any frame found pinned when the
+ * pending accesses are handed over, is parked: it is marked not evictable in the replacer, and made evictable again
+ * by the next eviction that finds it unpinned.
  */
 class BufferPoolManager {
  public:
@@ -37,20 +92,58 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param replacer_k the lookback constant k for the LRU-K replacer
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy of the buffer pool
    */
   BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                    LogManager *log_manager = nullptr);
+                    LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRUK);
+
+  /**
+   * @brief Creates a new BufferPoolManager that is one shard of a ParallelBufferPoolManager.
+   *
+   * The instance only allocates page ids p with p % num_instances == instance_index, so that the parallel buffer pool
+   * can route every page id back to the instance that owns it.
+   *
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of instances in the parallel buffer pool
+   * @param instance_index index of this instance in the parallel buffer pool
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy of the buffer pool
+   */
+  BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index, DiskManager *disk_manager,
+                    size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                    ReplacerType replacer_type = ReplacerType::LRUK);
 
   /**
    * @brief Destroy an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager();
 
   /** @brief Return the size (number of frames) of the buffer pool. */
-  auto GetPoolSize() -> size_t { return pool_size_; }
+  virtual auto GetPoolSize() -> size_t { return pool_size_; }
 
-  /** @brief Return the pointer to all the pages in the buffer pool. */
-  auto GetPages() -> Page * { return pages_; }
+  /** @brief Return the pointer to the pages the buffer pool was created with, see Resize(). */
+  auto GetPages() -> Page * { return segments_[0].pages_; }
+
+  /**
+   * @brief Change the number of frames of the buffer pool while it is in use.
+   *
+   * Growing adds the new frames to the free list. The frames are allocated as a new segment, so the frames that are
+   * already in use never move. A new segment has at least as many frames as all segments before it, so the pool
+   * allocates ahead when it grows in small steps. A pool has at most MAX_FRAME_SEGMENTS segments and growing past
+   * them returns false, which cannot happen before the pool is 2^63 times its original size.
+   *
+   * Shrinking removes the frames at and above new_size: their dirty pages are written back (without holding the
+   * latch, like every other write) and their pages are dropped from the buffer pool. If any of these frames is pinned,
+   * the pool is left unchanged and false is returned, so the caller may retry later. The data of the removed frames
+   * is given back to the operating system if the pool uses a frame arena. Their book-keeping is kept until the pool is
+   * destroyed, because a lock-free hit may still be looking at it, and is reused when the pool grows again.
+   *
+   * @param new_size the new number of frames, at least 1
+   * @return false if the pool could not be resized
+   */
+  virtual auto Resize(size_t new_size) -> bool;
 
   /**
    * TODO(P1): Add implementation
@@ -66,10 +159,13 @@ class BufferPoolManager {
    * so that the replacer wouldn't evict the frame before the buffer pool manager "Unpin"s it.
    * Also, remember to record the access history of the frame in the replacer for the lru-k algorithm to work.
    *
+   * A page that has been deleted before is reused if there is one, see AllocatePage().
+   *
    * @param[out] page_id id of created page
+   * @param hint a page id the new page should be close to on disk, e.g. the node that is split, or INVALID_PAGE_ID
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  auto NewPage(page_id_t *page_id) -> Page *;
+  virtual auto NewPage(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID) -> Page *;
 
   /**
    * TODO(P1): Add implementation
@@ -81,9 +177,10 @@ class BufferPoolManager {
    * BasicPageGuard structure.
    *
    * @param[out] page_id, the id of the new page
+   * @param hint a page id the new page should be close to on disk, or INVALID_PAGE_ID
    * @return BasicPageGuard holding a new page
    */
-  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+  auto NewPageGuarded(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID) -> BasicPageGuard;
 
   /**
    * TODO(P1): Add implementation
@@ -98,11 +195,13 @@ class BufferPoolManager {
    *
    * In addition, remember to disable eviction and record the access history of the frame like you did for NewPage().
    *
+   * A page that is in the buffer pool and not being read from disk is pinned without taking the latch, see above.
+   *
    * @param page_id id of page to be fetched
-   * @param access_type type of access to the page, only needed for leaderboard tests.
+   * @param access_type type of access to the page. Pages fetched only by scans are evicted first.
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
    */
-  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
+  virtual auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page *;
 
   /**
    * TODO(P1): Add implementation
@@ -115,11 +214,64 @@ class BufferPoolManager {
    * the returned page already has a read or write latch held, respectively.
    *
    * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page, AccessType::Scan for sequential scans.
    * @return PageGuard holding the fetched page
    */
-  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
-  auto FetchPageRead(page_id_t page_id) -> ReadPageGuard;
-  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+  auto FetchPageBasic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> BasicPageGuard;
+  auto FetchPageRead(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> ReadPageGuard;
+  auto FetchPageWrite(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> WritePageGuard;
+
+  /**
+   * @brief Fetch a page for an optimistic read, without taking its latch. See OptimisticReadGuard.
+   *
+   * @param page_id, the id of the page to fetch
+   * @param access_type type of access to the page
+   * @return OptimisticReadGuard holding the pinned page
+   */
+  auto FetchPageOptimistic(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> OptimisticReadGuard;
+
+  /**
+   * @brief Fetch a batch of pages, see FetchPage().
+   *
+   * All the pages are looked up and pinned under one acquisition of the latch, and the pages that are not in the
+   * buffer pool are then read from disk as one group of concurrent reads, instead of one read after the other.
+   *
+   * @param page_ids ids of the pages to fetch, a page id may appear more than once
+   * @param access_type type of access to the pages
+   * @return the fetched pages, in the order of page_ids; nullptr for a page that could not be fetched
+   */
+  virtual auto FetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown)
+      -> std::vector<Page *>;
+
+  /**
+   * @brief Create a batch of new pages, see NewPage().
+   *
+   * The frames of all the pages are taken under one acquisition of the latch, and the dirty pages they held are
+   * written back as one group of concurrent writes. Pages reused from the free page map are taken close to each other.
+   *
+   * @param num_pages number of pages to create
+   * @param[out] page_ids ids of the created pages
+   * @param hint a page id the new pages should be close to on disk, or INVALID_PAGE_ID
+   * @return the created pages, in the order of page_ids; fewer than num_pages if the frames ran out
+   */
+  virtual auto NewPages(size_t num_pages, std::vector<page_id_t> *page_ids, page_id_t hint = INVALID_PAGE_ID)
+      -> std::vector<Page *>;
+
+  /**
+   * @brief PageGuard wrappers for FetchPages and NewPages.
+   *
+   * The read and write latches are taken in the order of page_ids, so callers that latch several pages at once must
+   * pass them in a consistent order (e.g. sorted by page id) to avoid deadlocks. The guard of a page that could not be
+   * fetched holds no page.
+   */
+  auto FetchPagesBasic(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown)
+      -> std::vector<BasicPageGuard>;
+  auto FetchPagesRead(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown)
+      -> std::vector<ReadPageGuard>;
+  auto FetchPagesWrite(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown)
+      -> std::vector<WritePageGuard>;
+  auto NewPagesGuarded(size_t num_pages, std::vector<page_id_t> *page_ids, page_id_t hint = INVALID_PAGE_ID)
+      -> std::vector<BasicPageGuard>;
 
   /**
    * TODO(P1): Add implementation
@@ -130,12 +282,14 @@ class BufferPoolManager {
    * Decrement the pin count of a page. If the pin count reaches 0, the frame should be evictable by the replacer.
    * Also, set the dirty flag on the page to indicate if the page was modified.
    *
+   * Like a hit, this takes no lock unless the page is being moved in the page table concurrently.
+   *
    * @param page_id id of page to be unpinned
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @param access_type type of access to the page, only needed for leaderboard tests.
    * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
    */
-  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
+  virtual auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool;
 
   /**
    * TODO(P1): Add implementation
@@ -148,14 +302,17 @@ class BufferPoolManager {
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
-  auto FlushPage(page_id_t page_id) -> bool;
+  virtual auto FlushPage(page_id_t page_id) -> bool;
 
   /**
    * TODO(P1): Add implementation
    *
    * @brief Flush all the pages in the buffer pool to disk.
+   *
+   * The dirty pages are handed to the disk manager in one batch, so that it can write adjacent pages together, and
+   * the database file is synced once at the end. The free page map of the disk manager is written back as well.
    */
-  void FlushAllPages();
+  virtual void FlushAllPages();
 
   /**
    * TODO(P1): Add implementation
@@ -170,43 +327,326 @@ class BufferPoolManager {
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  auto DeletePage(page_id_t page_id) -> bool;
+  virtual auto DeletePage(page_id_t page_id) -> bool;
+
+  /** Reads the id of the next page in a linked list of pages (table pages, leaf pages) out of the page's data. */
+  using NextPageIdFn = page_id_t (*)(const char *page_data);
+
+  /**
+   * @brief Load pages into the buffer pool in the background.
+   *
+   * Returns immediately. The pages are fetched by a small pool of prefetch threads, which is started on first use, and
+   * are left unpinned in their frames. They are recorded as AccessType::Prefetch accesses, which do not count as a
+   * use of the page, see LRUKReplacer. Requests are dropped when the prefetch queue is full or when every frame is
+   * pinned.
+   *
+   * @param page_ids ids of the pages to load
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids);
+
+  /**
+   * @brief Load a linked list of pages into the buffer pool in the background, see PrefetchPages().
+   *
+   * @param page_id id of the first page to load
+   * @param num_pages number of pages to load, including the first one
+   * @param next_page_id reads the id of the next page out of a loaded page; INVALID_PAGE_ID ends the list
+   */
+  void PrefetchPageChain(page_id_t page_id, size_t num_pages, NextPageIdFn next_page_id);
+
+  /**
+   * @brief Start a background thread that writes dirty pages back before they are chosen as eviction victims.
+   *
+   * Every interval, the writer asks the replacer for the next batch_size frames it would evict, and writes back the
+   * ones that are dirty and unpinned, so that NewPage() and FetchPage() usually find a clean victim. A page is written
+   * while the writer holds its read latch, and its dirty flag is cleared before the write, so a modification made
+   * after the write marks it dirty again. If a writer is already running, it is restarted with the new settings.
+   *
+   * @param batch_size the maximum number of pages to write back every interval
+   * @param interval the time between two batches
+   */
+  virtual void StartBackgroundWriter(size_t batch_size, std::chrono::milliseconds interval);
+
+  /** @brief Stop the background writer, if it is running. */
+  virtual void StopBackgroundWriter();
+
+  /** @return the number of dirty pages written back by NewPage() and FetchPage() when they evicted them */
+  virtual auto GetForegroundWriteCount() -> size_t { return foreground_writes_.Load(); }
+
+  /** @return the number of dirty pages written back by the background writer */
+  virtual auto GetBackgroundWriteCount() -> size_t { return background_writes_.Load(); }
+
+  /**
+   * @brief Collect the counters of the buffer pool and its replacer, see BufferPoolStats.
+   *
+   * The counters are cheap to update from many threads and are only added up here, so this is meant for monitoring,
+   * not for the hot path. The frame counts are taken under the latch.
+   */
+  virtual auto GetStats() -> BufferPoolStats;
+
+ protected:
+  /** Used by ParallelBufferPoolManager, which owns no frames itself and forwards every call to its instances. */
+  BufferPoolManager() = default;
+
+  /**
+   * @brief Stop the prefetch threads and drop the pending requests. Prefetch threads call the virtual FetchPage(),
+   * so a derived class must call this in its destructor before it tears down its own state.
+   */
+  void StopPrefetch();
 
  private:
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;  // 缓冲池的大小
-  /** The next page id to be allocated  */
+  /** Flushes the dirty pages of all its instances together, see PinDirtyPages(). */
+  friend class ParallelBufferPoolManager;
+
+  /** Number of pages in the buffer pool. Only changed by Resize() under the latch. */
+  std::atomic<size_t> pool_size_{0};  // 缓冲池的大小
+  /** Number of instances in the parallel buffer pool this instance belongs to (1 if standalone). */
+  const uint32_t num_instances_{1};
+  /** Index of this instance in the parallel buffer pool (0 if standalone). */
+  const uint32_t instance_index_{0};
+  /** The next page id to be allocated, past the pages that were in the database file on startup */
   std::atomic<page_id_t> next_page_id_ = 0;
 
-  /** Array of buffer pool pages. */
-  Page *pages_;  // 缓冲池的页指针，其实是一个数组
+  /** Frames [first_frame_, first_frame_ + num_frames_), allocated at once by the constructor or by Resize(). */
+  struct FrameSegment {
+    size_t first_frame_{0};
+    size_t num_frames_{0};
+    Page *pages_{nullptr};
+    /** Data of the frames, unless the pool uses FrameLayout::PerPage. */
+    std::unique_ptr<FrameArena> arena_;
+  };
+  /** Every segment at least doubles the allocated frames, so this many segments are never used up. */
+  static constexpr size_t MAX_FRAME_SEGMENTS = 64;
+  /**
+   * Segments of buffer pool pages, in frame order. The frames past pool_size_ are unused. A segment is only added
+   * under the latch and never freed before the pool is destroyed, and a segment is filled in before any frame id in it
+   * is handed out, so GetFrame() needs no latch.
+   */
+  std::array<FrameSegment, MAX_FRAME_SEGMENTS> segments_;  // 缓冲池的页，分段存放，扩容的时候已有的页不会移动
+  size_t num_segments_{0};
+  /** Layout of the frame data, fixed when the pool is created. */
+  FrameLayout frame_layout_{FrameLayout::PerPage};
+  /** Serializes Resize() calls, which release the latch while writing back pages. */
+  std::mutex resize_latch_;
   /** Pointer to the disk manager. */
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_ __attribute__((__unused__)){nullptr};
+  /** Every page read and write of the buffer pool goes through the disk scheduler, without holding the latch. */
+  std::unique_ptr<DiskScheduler> disk_scheduler_;
   /** Pointer to the log manager. Please ignore this for P1. */
-  LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  LogManager *log_manager_ __attribute__((__unused__)){nullptr};
+  /** Page table for keeping track of buffer pool pages. Written under the latch, read without it by hits. */
+  PageTable page_table_{0};
   // 物理页到虚拟页的映射，page_id_t物理页，frame_id_t虚拟缓冲池的页
   /** Replacer to find unpinned pages for replacement. */
-  std::unique_ptr<LRUKReplacer> replacer_;  // 构建一个replacer给予LRU-K淘汰页
+  std::unique_ptr<Replacer> replacer_;  // 构建一个replacer给予淘汰页，默认是LRU-K
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;  // 缓冲池中空闲的页号
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
-  std::mutex latch_;  // 锁
+  /** Accesses of lock-free hits that are not yet recorded in the replacer, see DrainAccesses(). */
+  AccessBuffer accesses_;
+  /** Frames with parked_ set, see Park(). */
+  std::vector<frame_id_t> parked_frames_;
+  /** Protects the background writer thread and its stop flag. */
+  std::mutex background_writer_latch_;
+  /** Signalled when the background writer is stopped. */
+  std::condition_variable background_writer_cv_;
+  std::thread background_writer_;
+  bool background_writer_stop_{false};
+  /** Dirty pages written back on the eviction path and by the background writer. */
+  StatCounter foreground_writes_;
+  StatCounter background_writes_;
+  /** Counters reported by GetStats(). */
+  StatCounter hits_;
+  StatCounter misses_;
+  StatCounter prefetch_reads_;
+  StatCounter new_pages_;
+  StatCounter evictions_;
+  StatCounter all_pinned_;
+  StatCounter pin_waits_;
+
+  /** A pending prefetch of num_pages_ pages of a list starting at page_id_. */
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    size_t num_pages_;
+    NextPageIdFn next_page_id_;
+  };
+  /** Protects the prefetch queue, threads and stop flag. */
+  std::mutex prefetch_latch_;
+  /** Signalled when a prefetch request is queued or the prefetch threads are stopped. */
+  std::condition_variable prefetch_cv_;
+  std::deque<PrefetchRequest> prefetch_queue_;
+  std::vector<std::thread> prefetch_threads_;
+  bool prefetch_stop_{false};
+
+  /** Pages that were evicted while dirty and are still being written back, mapped to the frame they lived in. */
+  std::unordered_map<page_id_t, frame_id_t> writing_back_;
+  /**
+   * This latch serializes the writers of the page table and protects the free list, writing_back_, the replacer and
+   * the I/O state of every page. A frame only changes its page while its pin count is -1, which only the holder of the
+   * latch can set. It is never held across a disk read or write.
+   */
+  TimedMutex latch_;  // 锁
+
+  /** @return the page of a frame */
+  auto GetFrame(frame_id_t frame_id) -> Page & {
+    size_t i = 0;
+    while (static_cast<size_t>(frame_id) >= segments_[i].first_frame_ + segments_[i].num_frames_) {
+      i++;
+    }
+    return segments_[i].pages_[frame_id - segments_[i].first_frame_];
+  }
+
+  /** @brief Allocate a segment for num_frames frames after the last one. Caller must hold the latch. */
+  void AddFrameSegment(size_t num_frames);
+
+  /** @brief Free the last segment. Only used by the destructor. */
+  void FreeLastFrameSegment();
+
+  /** @brief Give the data of frames [first_frame, last_frame) back to the operating system. */
+  void ReleaseFrames(size_t first_frame, size_t last_frame);
+
+  /**
+   * @brief Pin a page that is in the buffer pool, without the latch.
+   * @return the pinned page, or nullptr if the page was not found and the caller has to take the slow path
+   */
+  auto PinResidentPage(page_id_t page_id, AccessType access_type) -> Page *;
+
+  /**
+   * @brief Increment the pin count of a page unless it is -1.
+   * @return false if the frame is free or being taken over
+   */
+  static auto TryPin(Page *page) -> bool {
+    int pin_count = page->pin_count_.load(std::memory_order_relaxed);
+    while (pin_count >= 0) {
+      if (page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1, std::memory_order_acquire)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Decrement the pin count of a page unless it is 0, see UnpinPage().
+   * @return false if the page was not pinned
+   */
+  static auto ReleasePin(Page *page, bool is_dirty) -> bool;
+
+  /** @brief Record the accesses of the hits since the last call in the replacer. Caller must hold the latch. */
+  void DrainAccesses();
+
+  /** @brief Mark a frame as not evictable in the replacer until it is unpinned. Caller must hold the latch. */
+  void Park(frame_id_t frame_id);
+
+  /** @brief Make the parked frames that are no longer pinned evictable again. Caller must hold the latch. */
+  void UnparkFrames();
+
+  /** @brief Stop tracking a frame in the replacer, e.g. when its page is deleted. Caller must hold the latch. */
+  void ForgetFrame(frame_id_t frame_id);
+
+  /**
+   * @brief Take a frame from the free list, or evict one from the replacer. Caller should acquire the latch before
+   * calling this function.
+   *
+   * The evicted page is removed from the page table. If it was dirty, it is added to writing_back_ and its id is
+   * returned through victim_page_id, and the caller must write it back through LoadFrame().
+   *
+   * The frame is returned with pin count -1 and io_in_progress_ set, so that no hit can pin it before the caller has
+   * given it its new page and stored its pin count.
+   *
+   * @param[out] frame_id the acquired frame
+   * @param[out] victim_page_id the dirty page that must be written back before the frame is reused, or INVALID_PAGE_ID
+   * @return false if every frame is pinned
+   */
+  auto AcquireFrame(frame_id_t *frame_id, page_id_t *victim_page_id) -> bool;
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Write back the victim page of a frame and fill the frame with its new page, without holding the latch.
+   *
+   * The frame must already be pinned and mapped to its new page. While the I/O is in flight the frame is marked
+   * io_in_progress_, so that other requesters of the same page wait on its condition variable, while requests for
+   * every other page proceed. The latch is held on entry and on return.
+   *
+   * @param lock the caller's lock on latch_
+   * @param frame_id the frame to fill
+   * @param victim_page_id the dirty page to write back first, or INVALID_PAGE_ID
+   * @param read_from_disk true to read the new page from disk, false to zero it out
+   */
+  void LoadFrame(std::unique_lock<TimedMutex> *lock, frame_id_t frame_id, page_id_t victim_page_id,
+                 bool read_from_disk);
+
+  /** The I/O that fills a frame with its new page, see LoadFrame(). */
+  struct FrameLoad {
+    frame_id_t frame_id_;
+    page_id_t victim_page_id_;
+    bool read_from_disk_;
+  };
+
+  /**
+   * @brief Fill several frames like LoadFrame(), submitting the I/O of all the frames to the disk scheduler at once:
+   * first the write-backs of the victims, then the reads. The latch is held on entry and on return.
+   */
+  void LoadFrames(std::unique_lock<TimedMutex> *lock, const std::vector<FrameLoad> &loads);
+
+  /**
+   * @brief Pin every dirty page of the buffer pool and clear its dirty flag, for FlushAllPages().
+   * @param[out] pages the pinned pages are appended here
+   */
+  void PinDirtyPages(std::vector<Page *> *pages);
+
+  /**
+   * @brief Write pages pinned by PinDirtyPages() with one WritePages() call, sync the file and unpin them. Pages of
+   * several instances of a parallel buffer pool can be written together.
+   */
+  static void WriteDirtyPages(DiskManager *disk_manager, const std::vector<Page *> &pages);
+
+  /**
+   * @brief Write back the dirty, unpinned pages among the next batch_size eviction candidates.
+   * @return the number of pages written
+   */
+  auto WriteBackEvictionCandidates(size_t batch_size) -> size_t;
+
+  /** @brief Queue a prefetch request, starting the prefetch threads if they are not running yet. */
+  void EnqueuePrefetch(const PrefetchRequest &request);
+
+  /** @brief Body of a prefetch thread: serve prefetch requests until StopPrefetch() is called. */
+  void PrefetchLoop();
+
+  /**
+   * @brief Allocate a page on disk.
+   *
+   * A free page of this instance is taken from the free page map of the disk manager, as close to hint as possible.
+   * The free page map has its own latch, so the caller must not hold latch_. If there is no free page, a new
+   * page id is only reserved, see AllocateNewPageId(), and allocated after the caller got a frame for it.
+   *
+   * @param hint a page id to allocate close to, or INVALID_PAGE_ID
+   * @return the id of the allocated page, or INVALID_PAGE_ID if a new page id has to be allocated
+   */
+  auto AllocatePage(page_id_t hint) -> page_id_t;
+
+  /**
+   * @brief Allocate a page id past the end of the database file. Caller should acquire the latch before calling this
+   * function.
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocateNewPageId() -> page_id_t;
+
+  /** @return true if page_id is a page id that AllocateNewPageId() has handed out, not a map page or a foreign id */
+  auto IsAllocatedPageId(page_id_t page_id) const -> bool;
+
+  /**
+   * @brief Drop a stale copy of a page that AllocatePage() handed out again. Caller should acquire the latch before
+   * calling this function.
+   *
+   * A deleted page can be fetched again by a prefetch, or by a reader that followed a page id it read before the page
+   * was deleted. Mapping the reused page id to a new frame would leave two frames for it.
+   *
+   * @return false if the stale copy is pinned, then the caller has to give up the page id
+   */
+  auto DropStalePage(page_id_t page_id) -> bool;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Deallocate a page on disk, so that AllocatePage() can hand it out again. The caller must not hold latch_.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
 
   // TODO(student): You may add additional private members and helper functions
 };
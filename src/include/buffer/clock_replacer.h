@@ -12,7 +12,6 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
 #include <vector>
 
@@ -23,6 +22,10 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every tracked frame has a reference bit that is set when the frame is accessed. The clock hand sweeps over the
+ * frames, skipping non-evictable ones, clears the reference bits it passes and evicts the first evictable frame whose
+ * bit is already clear. Scan and prefetch accesses do not set the reference bit, so scanned pages go first.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -37,16 +40,41 @@ class ClockReplacer : public Replacer {
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @brief Make room for frame ids up to num_frames, see Replacer::Resize(). */
+  void Resize(size_t num_frames) override;
+
+  /** Same as Evict(). */
+  auto Victim(frame_id_t *frame_id) -> bool { return Evict(frame_id); }
+
+  /** Mark a frame as non-evictable. */
+  void Pin(frame_id_t frame_id) { SetEvictable(frame_id, false); }
+
+  /** Add a frame to the replacer as an evictable frame that was just accessed, if it is not evictable yet. */
+  void Unpin(frame_id_t frame_id);
+
  private:
-  // TODO(student): implement me!
+  std::mutex latch_;
+  size_t num_frames_;
+  /** Position of the clock hand. */
+  size_t hand_{0};
+  /** Number of evictable frames. */
+  size_t curr_size_{0};
+  // 下面的数组都按帧号索引
+  std::vector<bool> is_tracked_;
+  std::vector<bool> is_evictable_;
+  std::vector<bool> ref_;
 };
 
 }  // namespace bustub
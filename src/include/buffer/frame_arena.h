@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of all frames of a buffer pool in one contiguous, page aligned region, so that a large
+ * pool is covered by few TLB entries instead of being scattered over the heap.
+ *
+ * The region is mapped anonymously, so it starts out zeroed. With FrameLayout::Arena the kernel is advised to back the
+ * region with transparent huge pages. With FrameLayout::HugeTlbArena the region is mapped with MAP_HUGETLB first, and
+ * falls back to the advised mapping when no huge pages are reserved.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map a region for the given number of frames.
+   * @param num_frames number of frames
+   * @param layout FrameLayout::Arena or FrameLayout::HugeTlbArena
+   */
+  FrameArena(size_t num_frames, FrameLayout layout);
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @brief Unmap the region. */
+  ~FrameArena();
+
+  /** @return the data of the given frame */
+  auto GetFrame(size_t frame_id) -> char * { return data_ + frame_id * BUSTUB_PAGE_SIZE; }
+
+  /**
+   * @brief Give the memory of some frames back to the operating system. The frames stay mapped and read as zeros
+   * until they are written again.
+   * @param first_frame the first frame to release
+   * @param num_frames number of frames to release
+   */
+  void Release(size_t first_frame, size_t num_frames);
+
+  /** @return true if the region is backed by MAP_HUGETLB huge pages */
+  auto IsHugeTlb() const -> bool { return huge_tlb_; }
+
+ private:
+  char *data_{nullptr};
+  /** Size of the mapping in bytes. */
+  size_t size_{0};
+  bool huge_tlb_{false};
+};
+
+}  // namespace bustub
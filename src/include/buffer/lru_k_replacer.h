@@ -13,29 +13,16 @@
 #pragma once
 
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
+#include "common/stats.h"
 
 namespace bustub {
 
-enum class AccessType { Unknown = 0, Get, Scan };
-
-class LRUKNode {
- private:
-  /** History of last seen K timestamps of this page. Least recent timestamp stored in front. */
-  // Remove maybe_unused if you start using them. Feel free to change the member variables as you want.
-
-  [[maybe_unused]] std::list<size_t> history_;
-  [[maybe_unused]] size_t k_;
-  [[maybe_unused]] frame_id_t fid_;
-  [[maybe_unused]] bool is_evictable_{false};
-};
-
 /**
  * LRUKReplacer implements the LRU-k replacement policy.
  *
@@ -46,8 +33,21 @@ class LRUKNode {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multipe frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * All state lives in flat arrays indexed by frame id. Each frame keeps a ring of its last k access timestamps, and the
+ * evictable frames are kept in an indexed binary min-heap ordered by (has fewer than k accesses ? 0 : 1, oldest
+ * timestamp in the ring). The heap top is therefore always the victim, and Evict, RecordAccess, SetEvictable and
+ * Remove are O(log n) no matter how many frames are pinned.
+ *
+ * Frames that have only ever been accessed with AccessType::Scan are cold: they keep just their latest scan timestamp
+ * and are evicted before any other frame, so that a sequential scan recycles its own frames instead of flushing the
+ * working set of point lookups out of the pool. A scan of a frame that already has other accesses leaves its history
+ * untouched, and a non-scan access of a cold frame starts a fresh history.
+ *
+ * A frame loaded by AccessType::Prefetch is treated like a frame with a single access until it is used, so that pages
+ * read ahead of a scan are not evicted by the read-ahead itself. The first real access replaces the prefetch access.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -65,7 +65,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -83,7 +83,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -95,10 +95,10 @@ class LRUKReplacer {
    * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
    *
    * @param frame_id id of frame that received a new access.
-   * @param access_type type of access that was received. This parameter is only needed for
-   * leaderboard tests.
+   * @param access_type type of access that was received. AccessType::Scan marks a frame without other accesses as
+   * cold, see above.
    */
-  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown);
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
 
   /**
    * TODO(P1): Add implementation
@@ -117,7 +117,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -136,7 +136,7 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
 
   /**
    * TODO(P1): Add implementation
@@ -145,25 +145,84 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
+
+  /**
+   * @brief Return the evictable frames that would be evicted next, in eviction order, without evicting them.
+   *
+   * Used by the background writer of the buffer pool to clean frames before they are chosen as victims.
+   *
+   * @param max_frames the maximum number of frames to return
+   * @return up to max_frames frames, the next victim first
+   */
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @brief Make room for frame ids up to num_frames, see Replacer::Resize(). */
+  void Resize(size_t num_frames) override;
+
+  /** @return the counters of the replacer, see ReplacerStats */
+  auto GetStats() -> ReplacerStats override;
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  [[maybe_unused]] std::unordered_map<frame_id_t, LRUKNode> node_store_;
-  [[maybe_unused]] size_t current_timestamp_{0};
-  size_t curr_size_{0};                        // 当前帧的容量
-  size_t replacer_size_;                       // LRU-K可以替换的帧的数量
-  size_t k_;                                   // k值
-  std::mutex latch_;                           // 互斥锁
-  std::vector<bool> is_accessible_;            // 向量数组表示哪一些帧可以被驱逐出去
-  std::unordered_map<int, size_t> use_count_;  // 每个帧出现频次的哈希表
-  // 历史队列
-  std::list<frame_id_t> history_list_;
-  std::unordered_map<frame_id_t, std::list<int>::iterator> history_map_;
-  // 缓存队列
-  std::list<frame_id_t> cache_list_;
-  std::unordered_map<frame_id_t, std::list<int>::iterator> cache_map_;
+  /** Position of a frame that is not in the heap. */
+  static constexpr size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+
+  /** @return the oldest timestamp in the history ring of the frame. Caller must hold latch_. */
+  auto OldestTimestamp(frame_id_t frame_id) const -> size_t {
+    return history_[frame_id * k_ + (access_count_[frame_id] < k_ ? 0 : history_head_[frame_id])];
+  }
+
+  /** @return true if frame a should be evicted before frame b. Caller must hold latch_. */
+  auto EvictBefore(frame_id_t a, frame_id_t b) const -> bool {
+    // 只被扫描访问过的冷帧最先被淘汰
+    if (is_cold_[a] != is_cold_[b]) {
+      return is_cold_[a];
+    }
+    // 访问次数不到k次的帧的后向k距离是+inf，总是先于访问满k次的帧被淘汰；同一类里比较最老的时间戳
+    const bool a_full = access_count_[a] >= k_;
+    const bool b_full = access_count_[b] >= k_;
+    if (a_full != b_full) {
+      return !a_full;
+    }
+    return OldestTimestamp(a) < OldestTimestamp(b);
+  }
+
+  void HeapPush(frame_id_t frame_id);
+  void HeapErase(frame_id_t frame_id);
+  void HeapFix(size_t pos);
+  void HeapSwap(size_t a, size_t b);
+  void ClearHistory(frame_id_t frame_id);
+
+  size_t current_timestamp_{0};
+  size_t replacer_size_;  // LRU-K可以替换的帧的数量
+  size_t k_;              // k值
+  std::mutex latch_;      // 互斥锁
+
+  // 下面的数组都按帧号索引，大小是replacer_size_ + 1（帧号可以等于replacer_size_）
+  /** Last k access timestamps of every frame, k slots per frame, used as a ring. */
+  std::vector<size_t> history_;
+  /** Slot in the ring of the frame that the next access is written to. */
+  std::vector<size_t> history_head_;
+  /** Number of recorded accesses of every frame. */
+  std::vector<size_t> access_count_;
+  /** Whether every frame is evictable. A frame is in heap_ iff it is evictable. */
+  std::vector<bool> is_evictable_;
+  /** Whether every frame has only been accessed by scans so far. */
+  std::vector<bool> is_cold_;
+  /** Whether every frame has been loaded by a prefetch and not accessed since. */
+  std::vector<bool> is_prefetched_;
+  /** Position of every frame in heap_, or NOT_IN_HEAP. */
+  std::vector<size_t> heap_pos_;
+  /** Binary min-heap of the evictable frames, ordered by EvictBefore(). */
+  std::vector<frame_id_t> heap_;
+
+  /** Counters reported by GetStats(). */
+  StatCounter accesses_;
+  StatCounter evictions_;
+  StatCounter evictions_below_k_;
+  StatCounter cold_evictions_;
+  StatCounter unused_prefetch_evictions_;
+  StatCounter failed_evictions_;
 };
 
 }  // namespace bustub
@@ -12,8 +12,9 @@
 
 #pragma once
 
-#include <list>
 #include <mutex>  // NOLINT
+#include <set>
+#include <utility>
 #include <vector>
 
 #include "buffer/replacer.h"
@@ -23,6 +24,8 @@ namespace bustub {
 
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * The evictable frames are kept in a set ordered by the timestamp of their last access.
  */
 class LRUReplacer : public Replacer {
  public:
@@ -37,16 +40,40 @@ class LRUReplacer : public Replacer {
    */
   ~LRUReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
-  void Pin(frame_id_t frame_id) override;
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
 
   auto Size() -> size_t override;
 
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @brief Make room for frame ids up to num_frames, see Replacer::Resize(). */
+  void Resize(size_t num_frames) override;
+
+  /** Same as Evict(). */
+  auto Victim(frame_id_t *frame_id) -> bool { return Evict(frame_id); }
+
+  /** Mark a frame as non-evictable. */
+  void Pin(frame_id_t frame_id) { SetEvictable(frame_id, false); }
+
+  /** Add a frame to the replacer as an evictable frame that was just accessed, if it is not evictable yet. */
+  void Unpin(frame_id_t frame_id);
+
  private:
-  // TODO(student): implement me!
+  std::mutex latch_;
+  size_t num_frames_;
+  size_t current_timestamp_{0};
+  // 下面的数组都按帧号索引
+  std::vector<bool> is_tracked_;
+  std::vector<bool> is_evictable_;
+  std::vector<size_t> last_access_;
+  /** Evictable frames ordered by (last access, frame id). */
+  std::set<std::pair<size_t, frame_id_t>> lru_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages in a buffer pool to the frames holding them.
+ *
+ * It is an open addressing hash table with linear probing. Every slot is one 64-bit atomic holding both the page id
+ * and the frame id, so a reader never sees half of an entry. The table is kept at most half full.
+ *
+ * Find() takes no lock and may run concurrently with Insert() and Erase(), which must be serialized by the caller (the
+ * buffer pool latch). Erase() shifts the following entries of the probe sequence back instead of leaving tombstones,
+ * so a concurrent Find() may miss an entry that is being moved, or return the frame of an entry that was just erased.
+ * A lock-free lookup is therefore only a hint: the caller checks the page id of the frame it got, and repeats the
+ * lookup under the writer lock if it missed. A Find() by the writer itself is exact.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create an empty page table.
+   * @param num_frames the number of frames of the buffer pool, i.e. the maximum number of entries
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  ~PageTable();
+
+  /**
+   * @brief Look up the frame of a page. Needs no lock, see above.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame of the page
+   * @return false if the page was not found
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+    const Table *table = table_.load(std::memory_order_acquire);
+    for (size_t i = table->Home(page_id);; i = (i + 1) & table->mask_) {
+      const uint64_t slot = table->slots_[i].load(std::memory_order_acquire);
+      if (slot == EMPTY) {
+        return false;
+      }
+      if (PageIdOf(slot) == page_id) {
+        *frame_id = FrameIdOf(slot);
+        return true;
+      }
+    }
+  }
+
+  /** @brief Map a page to a frame, replacing its previous frame if it has one. Caller must be the only writer. */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /** @brief Remove the entry of a page, if it has one. Caller must be the only writer. */
+  void Erase(page_id_t page_id);
+
+  /**
+   * @brief Make room for the entries of num_frames frames. Caller must be the only writer.
+   *
+   * If the table has to grow, the entries are copied into a new table that replaces the old one. Readers may still be
+   * probing the old table, so it is kept until the page table is destroyed; this only happens when the buffer pool
+   * grows past its largest size so far.
+   */
+  void Reserve(size_t num_frames);
+
+  /** @return the number of entries */
+  auto Size() const -> size_t { return size_; }
+
+ private:
+  /** An empty slot. No entry can look like this, since INVALID_PAGE_ID is never inserted. */
+  static constexpr uint64_t EMPTY = ~static_cast<uint64_t>(0);
+
+  static auto MakeSlot(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageIdOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameIdOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xffffffff); }
+
+  struct Table {
+    explicit Table(size_t capacity);
+
+    /** @return the first slot of the probe sequence of a page (Fibonacci hashing) */
+    auto Home(page_id_t page_id) const -> size_t {
+      return ((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> shift_) & mask_;
+    }
+
+    size_t mask_;
+    unsigned shift_;
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  };
+
+  /** @return the capacity of a table for num_frames entries: a power of two, at least twice num_frames */
+  static auto CapacityFor(size_t num_frames) -> size_t;
+
+  /** The current table. Replaced only by Reserve(). */
+  std::atomic<Table *> table_;
+  /** The current table and every table it replaced, see Reserve(). */
+  std::vector<std::unique_ptr<Table>> tables_;
+  /** Number of entries, only touched by the writer. */
+  size_t size_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager partitions the buffer pool into several independent BufferPoolManager instances.
+ *
+ * Every instance has its own latch, page table, free list and replacer. A page id is always owned by the instance
+ * `page_id % num_instances`, so operations on pages that live in different instances never contend with each other.
+ * Since it is a BufferPoolManager itself, the page guard API (FetchPageRead / FetchPageWrite / NewPageGuarded) and
+ * every user of BufferPoolManager (B+ tree, table heap, ...) work on it unchanged.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManager instances
+   * @param pool_size the pool size of each instance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRUK);
+
+  /**
+   * @brief Destroy an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @brief Return the total size (number of frames) of all instances. */
+  auto GetPoolSize() -> size_t override;
+
+  /**
+   * @brief Resize every instance, see BufferPoolManager::Resize(). The frames are split evenly over the instances.
+   *
+   * @param new_size the new total number of frames, at least one per instance
+   * @return false if some instance could not be resized; the instances that could are resized anyway
+   */
+  auto Resize(size_t new_size) -> bool override;
+
+  /** @brief Return the number of instances. */
+  auto GetNumInstances() -> size_t { return instances_.size(); }
+
+  /**
+   * @brief Create a new page. Instances are tried in round robin order, starting from a different instance on
+   * every call, until one of them has a free or evictable frame.
+   *
+   * @param[out] page_id id of created page
+   * @param hint a page id the new page should be close to on disk, or INVALID_PAGE_ID
+   * @return nullptr if no instance can create a new page, otherwise pointer to new page
+   */
+  auto NewPage(page_id_t *page_id, page_id_t hint = INVALID_PAGE_ID) -> Page * override;
+
+  /**
+   * @brief Fetch the requested page from the instance that owns it.
+   */
+  auto FetchPage(page_id_t page_id, AccessType access_type = AccessType::Unknown) -> Page * override;
+
+  /**
+   * @brief Fetch a batch of pages. The page ids are split by the instance that owns them, and every instance fetches
+   * its part as one batch.
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids, AccessType access_type = AccessType::Unknown)
+      -> std::vector<Page *> override;
+
+  /**
+   * @brief Create a batch of new pages. Like NewPage(), instances are tried in round robin order, and every instance
+   * creates as many of the missing pages as it can.
+   */
+  auto NewPages(size_t num_pages, std::vector<page_id_t> *page_ids, page_id_t hint = INVALID_PAGE_ID)
+      -> std::vector<Page *> override;
+
+  /**
+   * @brief Unpin the target page in the instance that owns it.
+   */
+  auto UnpinPage(page_id_t page_id, bool is_dirty, AccessType access_type = AccessType::Unknown) -> bool override;
+
+  /**
+   * @brief Flush the target page to disk through the instance that owns it.
+   */
+  auto FlushPage(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Flush all the pages of all instances to disk.
+   */
+  void FlushAllPages() override;
+
+  /**
+   * @brief Delete a page from the instance that owns it.
+   */
+  auto DeletePage(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Start a background writer in every instance.
+   */
+  void StartBackgroundWriter(size_t batch_size, std::chrono::milliseconds interval) override;
+
+  /**
+   * @brief Stop the background writers of all instances.
+   */
+  void StopBackgroundWriter() override;
+
+  /** @return the sum of the foreground writes of all instances */
+  auto GetForegroundWriteCount() -> size_t override;
+
+  /** @return the sum of the background writes of all instances */
+  auto GetBackgroundWriteCount() -> size_t override;
+
+  /** @return the sum of the counters of all instances */
+  auto GetStats() -> BufferPoolStats override;
+
+ private:
+  /**
+   * @brief Get the instance responsible for the given page id.
+   * @param page_id page id
+   * @return pointer to the BufferPoolManager responsible for handling the given page id
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager *;
+
+  /** The individual buffer pool instances. */
+  std::vector<std::unique_ptr<BufferPoolManager>> instances_;
+  /** The instance NewPage starts from on its next call. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
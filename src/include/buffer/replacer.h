@@ -12,12 +12,40 @@
 
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** How a page is accessed, passed from the buffer pool to the replacer. */
+enum class AccessType { Unknown = 0, Get, Scan, Prefetch };
+
+/** The replacement policies the buffer pool can be constructed with. */
+enum class ReplacerType { LRUK = 0, LRU, Clock, TwoQ, ARC };
+
+/** Counters of a replacer, see Replacer::GetStats(). */
+struct ReplacerStats {
+  /** Number of recorded accesses. */
+  uint64_t accesses_{0};
+  /** Number of evicted frames. */
+  uint64_t evictions_{0};
+  /** Number of other evicted frames that had fewer than k accesses, i.e. an infinite backward k-distance. */
+  uint64_t evictions_below_k_{0};
+  /** Number of evicted frames that had only been accessed by scans. */
+  uint64_t cold_evictions_{0};
+  /** Number of evicted frames that had been prefetched and never used. */
+  uint64_t unused_prefetch_evictions_{0};
+  /** Number of Evict() calls that found no evictable frame. */
+  uint64_t failed_evictions_{0};
+};
+
 /**
  * Replacer is an abstract class that tracks page usage.
+ *
+ * The buffer pool records every access of a frame, and marks a frame evictable while it is unpinned. Only evictable
+ * frames may be chosen as victims. Frame ids are in [0, num_frames].
  */
 class Replacer {
  public:
@@ -25,26 +53,58 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
+   * Remove the victim frame as defined by the replacement policy, along with its access history.
+   * @param[out] frame_id id of frame that was removed
    * @return true if a victim frame was found, false otherwise
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Record an access of the given frame. A frame that is not tracked yet starts being tracked as non-evictable.
+   * @param frame_id the id of the accessed frame
+   * @param access_type type of the access
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Mark a tracked frame as evictable or non-evictable. Does nothing for a frame that is not tracked.
+   * @param frame_id the id of the frame
+   * @param set_evictable whether the frame may be evicted
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
+
+  /**
+   * Stop tracking an evictable frame, without treating it as an eviction. Does nothing for a non-evictable frame.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) = 0;
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * @param max_frames the maximum number of frames to return
+   * @return the evictable frames that are likely to be evicted next, without evicting them
+   */
+  virtual auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> = 0;
+
+  /**
+   * Tell the replacer which page a frame holds from now on. Called before the first access of a newly loaded page.
+   * Policies that remember recently evicted pages (2Q, ARC) need this, the default ignores it.
+   * @param frame_id the id of the frame
+   * @param page_id the id of the page now held by the frame
+   */
+  virtual void SetPageId(frame_id_t frame_id, page_id_t page_id) {}
+
+  /**
+   * Resize the replacer for a buffer pool that now has num_frames frames, so that frame ids up to num_frames are
+   * valid. When the pool shrinks, it has already removed every frame at or above num_frames from the replacer.
+   * @param num_frames the new number of frames
+   */
+  virtual void Resize(size_t num_frames) = 0;
+
+  /** @return the counters of the replacer; policies that do not keep any return all zeros */
+  virtual auto GetStats() -> ReplacerStats { return {}; }
 };
 
 }  // namespace bustub
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_q_replacer.h
+//
+// Identification: src/include/buffer/two_q_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQReplacer implements the full version of the 2Q replacement policy (Johnson and Shasha, VLDB 1994).
+ *
+ * A newly loaded page enters A1in, a FIFO queue. Further accesses while it is in A1in are considered correlated and do
+ * not move it. When a page is evicted from A1in, its page id is remembered in the ghost queue A1out. A page that is
+ * loaded again while it is remembered in A1out was re-referenced after a while and enters Am, an LRU queue, directly.
+ * Pages are evicted from A1in while it holds more than Kin frames, and from Am otherwise. Pages that are only read
+ * once, like the pages of a sequential scan, never reach Am.
+ *
+ * The replacer learns the page held by a frame through SetPageId(). Frames whose page id is unknown always start in
+ * A1in.
+ */
+class TwoQReplacer : public Replacer {
+ public:
+  /**
+   * @brief Create a new TwoQReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQReplacer);
+
+  ~TwoQReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, AccessType access_type = AccessType::Unknown) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  /** @brief Make room for frame ids up to num_frames and size Kin and Kout for it, see Replacer::Resize(). */
+  void Resize(size_t num_frames) override;
+
+  void SetPageId(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  enum class Queue { None = 0, A1in, Am };
+
+  /** @return the set of evictable frames of the given queue. Caller must hold latch_. */
+  auto EvictableSet(Queue queue) -> std::set<std::pair<size_t, frame_id_t>> & {
+    return queue == Queue::A1in ? a1in_ : am_;
+  }
+
+  /** @return true if the next victim should come from A1in. Caller must hold latch_. */
+  auto PreferA1in() const -> bool { return am_.empty() || (!a1in_.empty() && a1in_size_ > kin_); }
+
+  /** Stop tracking a frame, remembering its page in A1out if it was evicted from A1in. Caller must hold latch_. */
+  void Untrack(frame_id_t frame_id, bool remember);
+
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  std::mutex latch_;
+  size_t num_frames_;
+  /** Target number of frames in A1in. */
+  size_t kin_;
+  /** Maximum number of page ids in A1out. */
+  size_t kout_;
+  size_t current_timestamp_{0};
+  /** Number of frames in A1in, evictable or not. */
+  size_t a1in_size_{0};
+
+  // 下面的数组都按帧号索引
+  std::vector<Queue> queue_;
+  std::vector<bool> is_evictable_;
+  /** Time the frame entered A1in, or the time of its last access in Am. */
+  std::vector<size_t> timestamp_;
+  std::vector<page_id_t> page_id_;
+
+  /** Evictable frames of A1in and Am, ordered by timestamp. */
+  std::set<std::pair<size_t, frame_id_t>> a1in_;
+  std::set<std::pair<size_t, frame_id_t>> am_;
+
+  /** Ghost queue of page ids evicted from A1in, most recent at the front. */
+  std::list<page_id_t> a1out_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> a1out_map_;
+};
+
+}  // namespace bustub
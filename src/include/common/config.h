@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -27,6 +28,20 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** Number of pages table and index iterators prefetch ahead of the page they are on, 0 disables read-ahead. */
+extern std::atomic<size_t> scan_read_ahead_pages;
+
+/**
+ * How a buffer pool allocates the data of its frames.
+ * - PerPage: a separate heap allocation per frame, so that ASAN catches accesses past the end of a page.
+ * - Arena: one page aligned region for all frames, backed by transparent huge pages where the kernel allows it.
+ * - HugeTlbArena: like Arena, but mapped with MAP_HUGETLB if huge pages are reserved.
+ */
+enum class FrameLayout { PerPage = 0, Arena, HugeTlbArena };
+
+/** Frame layout of buffer pools created from now on. Defaults to PerPage in ASAN builds and to Arena otherwise. */
+extern std::atomic<FrameLayout> buffer_pool_frame_layout;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
@@ -35,7 +50,11 @@ static constexpr int BUSTUB_PAGE_SIZE = 4096;
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
-static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int LRUK_REPLACER_K = 10;              // lookback window for lru-k replacer
+static constexpr int BUFFER_POOL_PREFETCH_THREADS = 2;  // number of threads serving prefetch requests of a buffer pool
+static constexpr int DISK_SCHEDULER_QUEUE_DEPTH = 64;   // max number of disk requests queued or in flight per scheduler
+static constexpr int DISK_SCHEDULER_THREADS = 4;        // number of worker threads when io_uring is not available
+static constexpr double BULK_LOAD_FILL_FACTOR = 0.9;    // share of a B+ tree page that bulk loading fills
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
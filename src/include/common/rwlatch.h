@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>  // NOLINT
 #include <shared_mutex>
 
@@ -21,18 +23,71 @@ namespace bustub {
 
 /**
  * Reader-Writer latch backed by std::mutex.
+ *
+ * The latch also keeps a version counter for optimistic readers, like a seqlock: it is odd while a writer holds the
+ * latch and bumped again when the writer releases it. A reader that saw the same even version before and after reading
+ * knows that no writer touched the protected data in between.
+ *
+ * std::shared_mutex cannot change the mode it is held in, so every writer also holds writer_gate_ from before it
+ * acquires the write latch until after it releases it. A reader that gets the gate can drop its read latch and take the
+ * write latch without any other writer getting in between, which is how TryUpgrade() works, and a writer can trade its
+ * write latch for a read latch the same way in Downgrade(). Readers never touch the gate.
  */
 class ReaderWriterLatch {
  public:
   /**
    * Acquire a write latch.
    */
-  void WLock() { mutex_.lock(); }
+  void WLock() {
+    writer_gate_.lock();
+    mutex_.lock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    // 写数据不能被重排到版本号变成奇数之前
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /**
    * Release a write latch.
    */
-  void WUnlock() { mutex_.unlock(); }
+  void WUnlock() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    mutex_.unlock();
+    writer_gate_.unlock();
+  }
+
+  /**
+   * Try to turn a read latch held by the caller into a write latch, without blocking.
+   *
+   * Fails if another writer holds or waits for the latch, or if another reader holds it. On failure the caller still
+   * holds its read latch, and either way no writer touched the protected data in between.
+   *
+   * @return true if the caller now holds the write latch instead of the read latch
+   */
+  auto TryUpgrade() -> bool {
+    if (!writer_gate_.try_lock()) {
+      return false;
+    }
+    // 拿着writer_gate_，别的写者进不来，放掉读锁再拿回来中间数据不会变
+    mutex_.unlock_shared();
+    if (!mutex_.try_lock()) {
+      mutex_.lock_shared();
+      writer_gate_.unlock();
+      return false;
+    }
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Turn a write latch held by the caller into a read latch. No other writer can get the latch in between.
+   */
+  void Downgrade() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    mutex_.unlock();
+    mutex_.lock_shared();
+    writer_gate_.unlock();
+  }
 
   /**
    * Acquire a read latch.
@@ -44,8 +99,26 @@ class ReaderWriterLatch {
    */
   void RUnlock() { mutex_.unlock_shared(); }
 
+  /**
+   * @return the current version, to be validated after an optimistic read. Odd while a writer holds the latch.
+   */
+  auto Version() const -> uint64_t { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * @param version the version returned by Version() before the optimistic read
+   * @return true if no writer held the latch since Version() returned `version`
+   */
+  auto Validate(uint64_t version) const -> bool {
+    // 读数据不能被重排到第二次读版本号之后
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & 1) == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
+
  private:
   std::shared_mutex mutex_;
+  /** Held by every writer, see above. */
+  std::mutex writer_gate_;
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// stats.h
+//
+// Identification: src/include/common/stats.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+/**
+ * StatCounter is a counter for statistics that is cheap to increment from many threads at once.
+ *
+ * Every thread increments its own cache-line sized slot, so concurrent increments do not bounce a cache line between
+ * cores, and Load() adds up all the slots. Threads are spread over NUM_SLOTS slots round robin, so a slot is only
+ * shared when there are more threads than slots. Load() is not a snapshot across slots, which is fine for statistics.
+ */
+class StatCounter {
+ public:
+  static constexpr size_t NUM_SLOTS = 16;
+
+  /** @brief Add n to the counter. */
+  void Add(uint64_t n = 1) { slots_[Slot()].value_.fetch_add(n, std::memory_order_relaxed); }
+
+  /** @return the sum of all the slots */
+  auto Load() const -> uint64_t {
+    uint64_t sum = 0;
+    for (const auto &slot : slots_) {
+      sum += slot.value_.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  struct alignas(64) PaddedCounter {
+    std::atomic<uint64_t> value_{0};
+  };
+
+  /** @return the slot of the calling thread, the same for every counter */
+  static auto Slot() -> size_t {
+    static std::atomic<size_t> next_slot{0};
+    thread_local const size_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % NUM_SLOTS;
+    return slot;
+  }
+
+  std::array<PaddedCounter, NUM_SLOTS> slots_;
+};
+
+/**
+ * TimedMutex is a std::mutex that counts how often it was acquired and for how long it was held in total.
+ *
+ * It meets the Lockable requirements, so it works with std::unique_lock, std::lock_guard and
+ * std::condition_variable_any. The counters are only written by the holder of the mutex, so they need no
+ * read-modify-write; they are atomic only so that they can be read at any time.
+ */
+class TimedMutex {
+ public:
+  void lock() {  // NOLINT
+    mutex_.lock();
+    Acquired();
+  }
+
+  auto try_lock() -> bool {  // NOLINT
+    if (!mutex_.try_lock()) {
+      return false;
+    }
+    Acquired();
+    return true;
+  }
+
+  void unlock() {  // NOLINT
+    const auto held = std::chrono::steady_clock::now() - acquired_at_;
+    hold_ns_.store(hold_ns_.load(std::memory_order_relaxed) +
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(held).count(),
+                   std::memory_order_relaxed);
+    mutex_.unlock();
+  }
+
+  /** @return the number of times the mutex was acquired */
+  auto GetAcquisitions() const -> uint64_t { return acquisitions_.load(std::memory_order_relaxed); }
+
+  /** @return the total time the mutex was held, in nanoseconds, not counting the current holder */
+  auto GetHoldNanos() const -> uint64_t { return hold_ns_.load(std::memory_order_relaxed); }
+
+ private:
+  void Acquired() {
+    acquired_at_ = std::chrono::steady_clock::now();
+    acquisitions_.store(acquisitions_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  }
+
+  std::mutex mutex_;
+  std::chrono::steady_clock::time_point acquired_at_;
+  std::atomic<uint64_t> acquisitions_{0};
+  std::atomic<uint64_t> hold_ns_{0};
+};
+
+}  // namespace bustub
@@ -13,15 +13,51 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>  // NOLINT
 #include <fstream>
 #include <future>  // NOLINT
-#include <mutex>   // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "common/stats.h"
+#include "storage/disk/free_page_map.h"
 
 namespace bustub {
 
+enum class AccessType;
+
+/** Counters of the page writes of a disk manager, see DiskManager::GetStats(). */
+struct DiskManagerStats {
+  /** Number of pages written to the database file. */
+  uint64_t pages_written_{0};
+  /** Number of bytes written to the database file. */
+  uint64_t bytes_written_{0};
+  /** Number of write calls it took to write them; adjacent pages written by WritePages() share a call. */
+  uint64_t write_calls_{0};
+  /** Time spent in the write calls, in nanoseconds. Calls that overlap each count in full. */
+  uint64_t write_ns_{0};
+  /** Number of times the database file was synced to disk. */
+  uint64_t syncs_{0};
+  /** Time spent syncing the database file, in nanoseconds. */
+  uint64_t sync_ns_{0};
+
+  /** @return the pages written per second of write and sync time, 0 if nothing was written */
+  auto PagesPerSecond() const -> double { return PerSecond(pages_written_); }
+
+  /** @return the bytes written per second of write and sync time, 0 if nothing was written */
+  auto BytesPerSecond() const -> double { return PerSecond(bytes_written_); }
+
+ private:
+  auto PerSecond(uint64_t n) const -> double {
+    const uint64_t ns = write_ns_ + sync_ns_;
+    return ns == 0 ? 0 : static_cast<double>(n) * 1e9 / static_cast<double>(ns);
+  }
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
@@ -37,12 +73,13 @@ class DiskManager {
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  /** Writes back the free page map if ShutDown() was not called. */
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
-  void ShutDown();
+  virtual void ShutDown();
 
   /**
    * Write a page to the database file.
@@ -58,6 +95,29 @@ class DiskManager {
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Write several pages to the database file, in page id order. Disk managers that can write physically adjacent
+   * pages with one call do so. The pages are not synced, see Sync().
+   * @param pages the id and the raw data of every page to write, in any order, each page at most once
+   */
+  virtual void WritePages(std::vector<std::pair<page_id_t, const char *>> pages);
+
+  /**
+   * Make the pages written so far durable. The stream based DiskManager can only flush its stream to the OS.
+   */
+  virtual void Sync();
+
+  /** @return the counters of the page writes */
+  auto GetStats() const -> DiskManagerStats;
+
+  /**
+   * A hint from the buffer pool that a page is about to be read, and how. Disk managers that can make the OS read
+   * ahead use it; the others ignore it.
+   * @param page_id id of the page
+   * @param access_type the access the page is read for
+   */
+  virtual void AdviseAccess(page_id_t page_id, AccessType access_type) {}
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -92,7 +152,29 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
+  /**
+   * @return the map of the deallocated pages of the database file, shared by every buffer pool that uses this disk
+   * manager. It is persistent for a database file and in memory only for the in-memory disk managers.
+   */
+  auto GetFreePageMap() -> FreePageMap * { return free_page_map_.get(); }
+
  protected:
+  /**
+   * Count pages written by one or more write calls.
+   * @param num_pages the number of pages written
+   * @param num_calls the number of write calls that wrote them
+   * @param elapsed the time the calls took
+   */
+  void RecordWrites(size_t num_pages, size_t num_calls, std::chrono::nanoseconds elapsed);
+
+  /** Count a sync of the database file that took `elapsed`. */
+  void RecordSync(std::chrono::nanoseconds elapsed);
+
+  /**
+   * Open or create the log file next to the database file `file_name_`.
+   * @return false if the database file name has no extension to replace
+   */
+  auto OpenLog() -> bool;
   auto GetFileSize(const std::string &file_name) -> int;
   // stream to write log file
   std::fstream log_io_;
@@ -101,11 +183,19 @@ class DiskManager {
   std::fstream db_io_;
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
   // With multiple buffer pool instances, need to protect file access
   std::mutex db_io_latch_;
+  std::unique_ptr<FreePageMap> free_page_map_{std::make_unique<FreePageMap>(this, 0, false)};
+
+ private:
+  StatCounter pages_written_;
+  StatCounter write_calls_;
+  StatCounter write_ns_;
+  StatCounter syncs_;
+  StatCounter sync_ns_;
 };
 
 }  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 #include <array>
+#include <atomic>
 #include <cstring>
 #include <fstream>
 #include <future>  // NOLINT
@@ -58,70 +59,56 @@ class DiskManagerMemory : public DiskManager {
 };
 
 /**
- * DiskManagerMemory replicates the utility of DiskManager on memory. It is primarily used for
- * data structure performance testing.
+ * DiskManagerUnlimitedMemory keeps every page that was ever written in memory. It is primarily used for data structure
+ * performance testing.
+ *
+ * Pages live in a two-level directory: a fixed array of segment pointers, each segment a fixed array of page pointers.
+ * Segments and pages are allocated on their first write and installed with a CAS, and are never moved or freed before
+ * the disk manager is destroyed, so looking up an existing page takes no lock at all. Each page has its own latch, so
+ * only the I/O of the same page is serialized.
  */
 class DiskManagerUnlimitedMemory : public DiskManager {
  public:
+  /** Number of pages in a segment of the directory. */
+  static constexpr size_t SEGMENT_PAGES = 4096;
+  /** Number of segments in the directory. Page ids must be smaller than DIRECTORY_SEGMENTS * SEGMENT_PAGES. */
+  static constexpr size_t DIRECTORY_SEGMENTS = 16384;
+
   DiskManagerUnlimitedMemory() = default;
 
+  ~DiskManagerUnlimitedMemory() override;
+
   /**
    * Write a page to the database file.
    * @param page_id id of the page
    * @param page_data raw page data
    */
-  void WritePage(page_id_t page_id, const char *page_data) override {
-    if (latency_ > 0) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
-    }
-
-    std::unique_lock<std::mutex> l(mutex_);
-    if (page_id >= static_cast<int>(data_.size())) {
-      data_.resize(page_id + 1);
-    }
-    if (data_[page_id] == nullptr) {
-      data_[page_id] = std::make_shared<ProtectedPage>();
-    }
-    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
-    std::unique_lock<std::shared_mutex> l_page(ptr->second);
-    l.unlock();
-
-    memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
-  }
+  void WritePage(page_id_t page_id, const char *page_data) override;
 
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
-  void ReadPage(page_id_t page_id, char *page_data) override {
-    if (latency_ > 0) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
-    }
-
-    std::unique_lock<std::mutex> l(mutex_);
-    if (page_id >= static_cast<int>(data_.size()) || page_id < 0) {
-      LOG_WARN("page not exist");
-      return;
-    }
-    if (data_[page_id] == nullptr) {
-      LOG_WARN("page not exist");
-      return;
-    }
-    std::shared_ptr<ProtectedPage> ptr = data_[page_id];
-    std::shared_lock<std::shared_mutex> l_page(ptr->second);
-    l.unlock();
-
-    memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
-  }
+  void ReadPage(page_id_t page_id, char *page_data) override;
 
   void SetLatency(size_t latency_ms) { latency_ = latency_ms; }
 
  private:
-  std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
-  using ProtectedPage = std::pair<Page, std::shared_mutex>;
-  std::vector<std::shared_ptr<ProtectedPage>> data_;
+  struct ProtectedPage {
+    Page data_{};
+    std::shared_mutex latch_;
+  };
+  using Segment = std::array<std::atomic<ProtectedPage *>, SEGMENT_PAGES>;
+
+  /** @return the page, or nullptr if it was never written */
+  auto FindPage(page_id_t page_id) const -> ProtectedPage *;
+
+  /** @return the page, allocated if it was never written */
+  auto FindOrCreatePage(page_id_t page_id) -> ProtectedPage *;
+
+  std::array<std::atomic<Segment *>, DIRECTORY_SEGMENTS> directory_{};
   size_t latency_{0};
 };
 
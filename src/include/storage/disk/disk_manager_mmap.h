@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <shared_mutex>
+#include <string>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap serves a database file read-only from a memory mapping, for replicas that only read.
+ *
+ * ReadPage() is a memcpy from the mapping, without a system call unless the page has to be faulted in. The mapping
+ * starts out with MADV_RANDOM, so that point lookups do not make the kernel read around them, and AdviseAccess()
+ * switches the pages ahead of a scan to MADV_SEQUENTIAL and asks for them with MADV_WILLNEED. Prefetched pages are
+ * asked for one by one.
+ *
+ * The file may keep growing, e.g. by a primary that writes it: reading a page past the end of the mapping maps the
+ * file again, and pages past the end of the file read as zeros. WritePage() throws, as a read-only replica must not
+ * dirty its pages.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /** Number of pages ahead of a scan that are advised at once. */
+  static constexpr size_t SCAN_READAHEAD_PAGES = 64;
+
+  /**
+   * Maps an existing database file.
+   * @param db_file the file name of the database file to read
+   */
+  explicit DiskManagerMmap(const std::string &db_file);
+
+  ~DiskManagerMmap() override;
+
+  /**
+   * Unmap and close the database file.
+   */
+  void ShutDown() override;
+
+  /**
+   * Always throws, the mapping is read-only.
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Copy a page out of the mapping.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Advise the kernel about the pages ahead of a scan, or about a prefetched page. Other accesses are not advised.
+   * @param page_id id of the page about to be read
+   * @param access_type the access the page is read for
+   */
+  void AdviseAccess(page_id_t page_id, AccessType access_type) override;
+
+  /** @return the number of bytes of the file that are mapped */
+  auto GetMappedSize() -> size_t;
+
+ private:
+  /** Map the file again if it grew past the mapping. Caller must not hold mapping_latch_. */
+  void Remap();
+
+  int fd_{-1};
+  /** Guards data_ and mapped_size_: shared for reads out of the mapping, exclusive to replace it. */
+  std::shared_mutex mapping_latch_;
+  char *data_{nullptr};
+  size_t mapped_size_{0};
+  /** Scans at or past this page get the next window advised. */
+  std::atomic<page_id_t> scan_advised_until_{0};
+};
+
+}  // namespace bustub
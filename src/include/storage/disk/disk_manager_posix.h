@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.h
+//
+// Identification: src/include/storage/disk/disk_manager_posix.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/uio.h>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerPosix reads and writes pages of the database file with positional pread/pwrite on a raw file descriptor.
+ *
+ * Unlike DiskManager, it keeps no stream cursor and takes no latch around page I/O, so reads and writes of different
+ * pages from different threads go to the kernel in parallel. The size of the file is tracked in memory instead of
+ * being asked with stat on every read. Reading a page at or beyond the end of the file gives a zeroed page.
+ *
+ * With direct I/O the file is opened with O_DIRECT (F_NOCACHE on macOS), so that pages cached by the buffer pool are
+ * not cached a second time by the OS. Page buffers that are not aligned to BUSTUB_PAGE_SIZE go through an aligned
+ * bounce buffer. If the file system does not support it, the file is opened without direct I/O instead, see
+ * IsDirectIO(). The log file is handled by DiskManager as before.
+ */
+class DiskManagerPosix : public DiskManager {
+ public:
+  /**
+   * Creates a new disk manager that writes to the specified database file.
+   * @param db_file the file name of the database file to write to
+   * @param direct_io true to bypass the OS page cache when the file system supports it
+   */
+  explicit DiskManagerPosix(const std::string &db_file, bool direct_io = false);
+
+  ~DiskManagerPosix() override;
+
+  /**
+   * Shut down the disk manager and close all the file resources.
+   */
+  void ShutDown() override;
+
+  /**
+   * Write a page to the database file.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Read a page from the database file.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Write several pages to the database file. The pages are sorted by page id, and each run of physically adjacent
+   * pages is written with one pwritev call.
+   * @param pages the id and the raw data of every page to write, in any order, each page at most once
+   */
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) override;
+
+  /**
+   * Make the pages written so far durable with one fsync of the database file.
+   */
+  void Sync() override;
+
+  /** @return the size of the database file in bytes, as tracked in memory */
+  auto GetDbFileSize() const -> int64_t { return file_size_.load(std::memory_order_acquire); }
+
+  /** @return true if the database file was opened for direct I/O */
+  auto IsDirectIO() const -> bool { return direct_io_; }
+
+  /** @return the file descriptor of the database file, for callers that submit page I/O themselves */
+  auto GetDbFd() const -> int { return fd_; }
+
+  /**
+   * Account for a page written to the database file descriptor without going through WritePage(), e.g. by the
+   * DiskScheduler through io_uring.
+   * @param page_id id of the written page
+   * @param elapsed the time the write took
+   */
+  void OnPageWritten(page_id_t page_id, std::chrono::nanoseconds elapsed) {
+    num_writes_ += 1;
+    RecordWrites(1, 1, elapsed);
+    GrowFileSize((static_cast<int64_t>(page_id) + 1) * BUSTUB_PAGE_SIZE);
+  }
+
+ private:
+  /**
+   * Write pages [first_page_id, first_page_id + iovs.size()) with pwritev, resuming after partial writes.
+   * @return false on an I/O error
+   */
+  auto WriteRun(page_id_t first_page_id, std::vector<iovec> iovs) -> bool;
+
+  /** Raise the tracked file size to at least `size`. */
+  void GrowFileSize(int64_t size);
+
+  int fd_{-1};
+  bool direct_io_{false};
+  std::atomic<int64_t> file_size_{0};
+};
+
+}  // namespace bustub
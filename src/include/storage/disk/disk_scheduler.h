@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <deque>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * @brief Represents a Write or Read request for the DiskManager to execute.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+
+  /**
+   *  Pointer to the start of the memory location where a page is either:
+   *   1. being read into from disk (on a read).
+   *   2. being written out to disk (on a write).
+   */
+  char *data_;
+
+  /** ID of the page being read from / written to disk. */
+  page_id_t page_id_;
+
+  /**
+   * Callback used to signal to the request issuer when the request has been completed. If the disk manager threw,
+   * the exception is passed on through the callback.
+   */
+  std::promise<bool> callback_;
+};
+
+/**
+ * @brief The DiskScheduler schedules disk read and write operations.
+ *
+ * A request is scheduled by calling DiskScheduler::Schedule() with an appropriate DiskRequest object. The request is
+ * executed in the background, and its callback is set once the page was read or written, so the issuer can overlap
+ * several requests and wait on their futures afterwards.
+ *
+ * When the disk manager is a DiskManagerPosix and the kernel supports it, requests are submitted to an io_uring by the
+ * calling thread and completed by one reaper thread. Otherwise a small pool of worker threads calls the disk manager.
+ * Either way at most queue_depth requests are queued or in flight, and Schedule() blocks until there is room. The
+ * threads and the ring are only set up by the first request.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * @param disk_manager the disk manager that executes the requests
+   * @param queue_depth the max number of requests queued or in flight
+   * @param use_io_uring false to always use the worker threads
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t queue_depth = DISK_SCHEDULER_QUEUE_DEPTH,
+                         bool use_io_uring = true);
+
+  /** Waits for the scheduled requests to complete and stops the background threads. */
+  ~DiskScheduler();
+
+  DiskScheduler(const DiskScheduler &) = delete;
+  auto operator=(const DiskScheduler &) -> DiskScheduler & = delete;
+
+  /**
+   * @brief Schedules a request for the DiskManager to execute. Blocks while queue_depth requests are pending.
+   * @param r The request to be scheduled.
+   */
+  void Schedule(DiskRequest r);
+
+  /**
+   * @brief Create a Promise object. If you want to implement your own version of promise, you can change this function
+   * so that our test cases can use your promise implementation.
+   *
+   * @return std::promise<bool>
+   */
+  auto CreatePromise() -> std::promise<bool> { return {}; };
+
+  /** @brief Schedule a read of a page into data and return the future of its callback. */
+  auto ScheduleRead(page_id_t page_id, char *data) -> std::future<bool>;
+
+  /** @brief Schedule a write of a page from data and return the future of its callback. */
+  auto ScheduleWrite(page_id_t page_id, const char *data) -> std::future<bool>;
+
+  /** @return true if the requests go through io_uring. Only known after the first request was scheduled. */
+  auto UsesIoUring() const -> bool { return ring_ != nullptr; }
+
+  /** @return the disk manager that executes the requests */
+  auto GetDiskManager() -> DiskManager * { return disk_manager_; }
+
+ private:
+  class IoUring;
+
+  /** Set up the ring, or the worker threads when there is no ring. Called once, by the first Schedule(). */
+  void Start();
+
+  /** Body of a worker thread: execute queued requests until the scheduler is destroyed. */
+  void WorkerLoop();
+
+  /** Execute a request synchronously through the disk manager and set its callback. */
+  void Execute(DiskRequest *r);
+
+  DiskManager *disk_manager_;
+  const size_t queue_depth_;
+  const bool use_io_uring_;
+  std::once_flag started_;
+
+  /** Non-null when the requests go through io_uring. */
+  std::unique_ptr<IoUring> ring_;
+
+  std::mutex latch_;
+  /** Signaled when a request is queued, or when the scheduler stops. */
+  std::condition_variable queue_cv_;
+  /** Signaled when a request is taken off the queue or completed, so that a blocked Schedule() can go on. */
+  std::condition_variable room_cv_;
+  /** Requests waiting for a worker thread. */
+  std::deque<DiskRequest> queue_;
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.h
+//
+// Identification: src/include/storage/disk/free_page_map.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class DiskManager;
+
+/**
+ * FreePageMap keeps track of the pages of the database file that have been deallocated, so that they can be handed
+ * out again instead of growing the file.
+ *
+ * The page ids are split into groups of PAGES_PER_GROUP pages. The second page of every group is a map page: a bitmap
+ * with one bit per page of its group, set when the page is free. Map pages are never handed out as data pages, and
+ * since a zero bit means "in use" a group that has never had a page freed needs no map page on disk at all. The map
+ * page sits at the start of its group so that it is skipped as soon as allocation enters the group and never lies
+ * past the end of the file; it is not the very first page so that page 0 stays the header page.
+ *
+ * A persistent map reads the map pages that are already in the file the first time it is used. Changed map pages are
+ * only written back by Flush(), which the buffer pool calls when it flushes all pages and the disk manager calls when
+ * it shuts down, so the map is as durable as the data pages. A map that is not persistent (for the in-memory disk
+ * managers) never touches the disk manager.
+ */
+class FreePageMap {
+ public:
+  /** Number of page ids in a group, including the map page at its end. */
+  static constexpr page_id_t PAGES_PER_GROUP = BUSTUB_PAGE_SIZE * 8;
+
+  /**
+   * @brief Create a free page map.
+   * @param disk_manager the disk manager the map pages are read from and written to
+   * @param num_pages_on_disk the number of pages already in the database file, map pages at or beyond it are not read
+   * @param persistent false to keep the map in memory only
+   */
+  FreePageMap(DiskManager *disk_manager, page_id_t num_pages_on_disk, bool persistent);
+
+  /** @return true if the page id is reserved for a map page and must never be allocated */
+  static auto IsMapPage(page_id_t page_id) -> bool { return page_id % PAGES_PER_GROUP == MAP_PAGE_OFFSET; }
+
+  /** @return the number of pages that were in the database file when the map was created */
+  auto GetNumPagesOnDisk() const -> page_id_t { return num_pages_on_disk_; }
+
+  /**
+   * @brief Mark a page as free. Freeing a page that is already free does nothing.
+   * @param page_id id of the page, must not be a map page
+   */
+  void Free(page_id_t page_id);
+
+  /**
+   * @brief Take a free page out of the map.
+   *
+   * Only pages with page_id % stride == offset are considered, so that every instance of a parallel buffer pool gets
+   * back pages that it owns. The page closest to hint is preferred (within a word of 64 pages), so that pages that
+   * are used together, e.g. the two halves of a split B+ tree node, end up close to each other in the file. Without
+   * a hint the free page with the lowest id is taken.
+   *
+   * @param hint a page id to allocate close to, or INVALID_PAGE_ID
+   * @param stride the number of buffer pool instances
+   * @param offset the index of the instance that allocates
+   * @return the id of the allocated page, or INVALID_PAGE_ID if there is no suitable free page
+   */
+  auto Allocate(page_id_t hint, uint32_t stride, uint32_t offset) -> page_id_t;
+
+  /** @return the number of free pages */
+  auto GetNumFreePages() -> size_t;
+
+  /** @brief Write back the map pages that changed since the last flush. */
+  void Flush();
+
+ private:
+  static constexpr size_t WORDS_PER_GROUP = BUSTUB_PAGE_SIZE / sizeof(uint64_t);
+  /** Position of the map page in its group. */
+  static constexpr page_id_t MAP_PAGE_OFFSET = 1;
+
+  /** A group with at least one free page. Groups that are not in groups_ have no free pages. */
+  struct Group {
+    Group() : bits_(new uint64_t[WORDS_PER_GROUP]()) {}
+    std::unique_ptr<uint64_t[]> bits_;
+    size_t num_free_{0};
+  };
+
+  /** @brief Read the map pages that are in the file, once. Caller must hold latch_. */
+  void Load();
+
+  /** @brief Remember that the map page of a group has to be written back. Caller must hold latch_. */
+  void MarkDirty(page_id_t group_no);
+
+  /**
+   * @brief Find a free page of a group with page_id % stride == offset close to hint_bit.
+   * @return the bit of the page in the group, or -1
+   */
+  static auto FindNear(const Group &group, page_id_t group_no, int hint_bit, uint32_t stride, uint32_t offset) -> int;
+
+  std::mutex latch_;
+  DiskManager *disk_manager_;
+  page_id_t num_pages_on_disk_;
+  bool persistent_;
+  bool loaded_{false};
+  size_t num_free_{0};
+  /** Groups with free pages, by group number. */
+  std::map<page_id_t, Group> groups_;
+  /** Groups whose map page changed since the last flush, including groups that no longer have free pages. */
+  std::set<page_id_t> dirty_groups_;
+};
+
+}  // namespace bustub
@@ -17,6 +17,7 @@
 #include <queue>
 #include <shared_mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "common/config.h"
@@ -80,16 +81,52 @@ class BPlusTree {
   // Insert a key-value pair into this B+ tree.
   auto Insert(const KeyType &key, const ValueType &value, Transaction *txn = nullptr) -> bool;
 
+  /**
+   * @brief Build the tree bottom-up from key-value pairs in any order, instead of inserting them one by one.
+   *
+   * The pairs are sorted, then packed into leaves left to right, then every level of internal pages is packed from the
+   * level below, until a single root is left. Each page is filled to about fill_factor of its capacity, but never less
+   * than its min size, so that later inserts and removes work as usual. Only the first pair of duplicate keys is kept.
+   *
+   * @param fill_factor share of each page to fill, in (0, 1]
+   * @return false if the tree is not empty, in which case nothing is loaded
+   */
+  auto BulkLoad(std::vector<std::pair<KeyType, ValueType>> entries, double fill_factor = BULK_LOAD_FILL_FACTOR)
+      -> bool;
+
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *txn);
   void RemoveEntry(page_id_t basic_page_id, const KeyType &key, Context &ctx);
 
   // Return the value associated with a given key
   auto GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn = nullptr) -> bool;
-  // 返回value对应leaf_page_id
-  auto GetKeyAt(const KeyType &key, const KeyComparator &comparator, Context &ctx) -> page_id_t;
+  /**
+   * @brief Go down to the leaf that covers key, or to the leftmost leaf if key is nullptr, and read latch it.
+   *
+   * This is the B-link descent of Lehman and Yao: the reader holds at most one latch at a time and keeps no latch on
+   * the parent while it waits for the child, it only pins the child first so that the child is not deleted in between.
+   * A child split in the meantime is caught by its high key, and the reader follows the right links to the page that
+   * now covers key. A page merged away, or keys moved to a left sibling by a redistribution, cannot be reached that
+   * way, so the reader starts over from the root then.
+   *
+   * @param[out] leaf_guard the read guard of the leaf
+   * @return false if the tree is empty
+   */
+  auto FindLeafRead(const KeyType *key, ReadPageGuard *leaf_guard) -> bool;
+  // 不加读锁从根走到key所在的叶子，和写者冲突时返回false；树是空的时候leaf_page_id是INVALID_PAGE_ID
+  auto OptimisticGetLeaf(const KeyType &key, OptimisticReadGuard *leaf_guard, page_id_t *leaf_page_id) -> bool;
   // Return the page id of the root node
   auto GetRootPageId() -> page_id_t;
+  /**
+   * @brief Go down to the leaf that may contain key with read latches, and write latch only the leaf. The read latch of
+   * the parent is held until the leaf is write latched, so the leaf is still the one for key, but any ancestor may have
+   * changed since: the caller can only modify the leaf in ways that do not touch its parent.
+   *
+   * @param[out] leaf_guard the write guard of the leaf
+   * @param[out] is_root true if the leaf is the root
+   * @return false if the tree is empty
+   */
+  auto GetLeafForWrite(const KeyType &key, WritePageGuard *leaf_guard, bool *is_root) -> bool;
   // 返回要插入的叶子页号
   auto InsertGetKeyAt(const KeyType &key, const KeyComparator &comparator, Context &ctx) -> page_id_t;
   // 返回要删除的样本所在的叶子页面
@@ -152,6 +189,25 @@ class BPlusTree {
    */
   auto ToPrintableBPlusTree(page_id_t root_id) -> PrintableBPlusTree;
 
+  /**
+   * @brief Split n entries into pages of about target entries each, with at least min_size entries per page if there
+   * is more than one page and at most max_size entries per page. If both bounds cannot hold, max_size wins and the
+   * pages get fewer than min_size entries.
+   * @return the number of entries of each page
+   */
+  static auto BulkLoadPageSizes(size_t n, int target, int min_size, int max_size) -> std::vector<int>;
+
+  /**
+   * @brief Pack one level of internal pages over the given children.
+   * @param children the first key under each child and its page id, in key order
+   * @return the first key under each new internal page and its page id
+   */
+  auto BulkLoadInternalLevel(const std::vector<std::pair<KeyType, page_id_t>> &children, double fill_factor)
+      -> std::vector<std::pair<KeyType, page_id_t>>;
+
+  /** Number of optimistic attempts of a lookup before it falls back to read latches. */
+  static constexpr int OPTIMISTIC_READ_RETRIES = 4;
+
   // member variable
   std::string index_name_;
   BufferPoolManager *bpm_;
@@ -14,6 +14,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/hash_function.h"
@@ -35,6 +36,12 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  /**
+   * Build the index from scratch out of (key tuple, rid) pairs in any order, see BPlusTree::BulkLoad.
+   * @return false if the index is not empty
+   */
+  auto BulkLoad(const std::vector<std::pair<Tuple, RID>> &entries, Transaction *transaction) -> bool;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
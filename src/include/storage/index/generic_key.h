@@ -12,9 +12,14 @@
 
 #pragma once
 
+#include <cstdint>
 #include <cstring>
+#include <ostream>
+#include <string>
 
+#include "catalog/schema.h"
 #include "storage/table/tuple.h"
+#include "type/type.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -25,26 +30,44 @@ namespace bustub {
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * When every column of the key schema is fixed-size, the key is stored normalized: each column is encoded at its offset
+ * so that comparing two keys byte by byte (memcmp) gives the same order as comparing their values column by column.
+ * Integers and booleans are stored big-endian with the sign bit flipped, decimals with the sign bit flipped (all bits
+ * when negative). The NULL value of an integer type is its minimum, encoded as all zero bytes, so NULLs sort first.
+ * Keys with VARCHAR columns keep the raw tuple data and are compared value by value.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    if (!key_schema->IsInlined()) {
+      memcpy(data_, tuple.GetData(), tuple.GetLength());
+      return;
+    }
+    for (const auto &col : key_schema->GetColumns()) {
+      EncodeColumn(tuple.GetData() + col.GetOffset(), col.GetType(), data_ + col.GetOffset());
+    }
   }
 
   // NOTE: for test purpose only
+  // the key schema must be a single INTEGER column for GenericKey<4>, and start with a BIGINT column otherwise
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    EncodeColumn(reinterpret_cast<const char *>(&key), IntegerKeyType(), data_);
   }
 
   inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
-    const char *data_ptr;
     const auto &col = schema->GetColumn(column_idx);
     const TypeId column_type = col.GetType();
+    if (schema->IsInlined()) {
+      char raw[sizeof(int64_t)];
+      DecodeColumn(data_ + col.GetOffset(), column_type, raw);
+      return Value::DeserializeFrom(raw, column_type);
+    }
+    const char *data_ptr;
     const bool is_inlined = col.IsInlined();
     if (is_inlined) {
       data_ptr = (data_ + col.GetOffset());
@@ -56,11 +79,29 @@ class GenericKey {
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline auto ToString() const -> int64_t { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // decode the first column as written by SetFromInteger(): a normalized INTEGER for GenericKey<4>, a normalized
+  // BIGINT otherwise. Keys of any other schema print meaningless numbers, use ToString(key_schema) for them.
+  inline auto ToString() const -> int64_t {
+    int64_t key = 0;
+    DecodeColumn(data_, IntegerKeyType(), reinterpret_cast<char *>(&key));
+    // INTEGER只解码了低4个字节，补上符号位
+    return IntegerKeyType() == TypeId::INTEGER ? static_cast<int32_t>(key) : key;
+  }
+
+  /** @return every column of the key decoded by its type in key_schema, as "(v1, v2, ...)" */
+  inline auto ToString(Schema *key_schema) const -> std::string {
+    std::string str = "(";
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      if (i > 0) {
+        str += ", ";
+      }
+      str += ToValue(key_schema, i).ToString();
+    }
+    return str + ")";
+  }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // print the key as ToString() does, so it has the same restrictions
   friend auto operator<<(std::ostream &os, const GenericKey &key) -> std::ostream & {
     os << key.ToString();
     return os;
@@ -68,6 +109,59 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  /** The type of the single integer column of the keys SetFromInteger() writes, a BIGINT unless it does not fit. */
+  static constexpr auto IntegerKeyType() -> TypeId {
+    return KeySize < sizeof(int64_t) ? TypeId::INTEGER : TypeId::BIGINT;
+  }
+
+  /** Store the unsigned integer v big-endian in the first `size` bytes of dst. */
+  static inline void StoreBigEndian(uint64_t v, size_t size, char *dst) {
+    for (size_t i = 0; i < size; i++) {
+      dst[i] = static_cast<char>(v >> (8 * (size - 1 - i)));
+    }
+  }
+
+  static inline auto LoadBigEndian(const char *src, size_t size) -> uint64_t {
+    uint64_t v = 0;
+    for (size_t i = 0; i < size; i++) {
+      v = (v << 8) | static_cast<uint8_t>(src[i]);
+    }
+    return v;
+  }
+
+  /** Encode one fixed-size column from its tuple layout at src into its normalized form at dst. */
+  static inline void EncodeColumn(const char *src, TypeId type, char *dst) {
+    const size_t size = Type::GetTypeSize(type);
+    uint64_t v = 0;
+    memcpy(&v, src, size);
+    switch (type) {
+      case TypeId::DECIMAL:
+        v = (v >> 63) != 0 ? ~v : v ^ (uint64_t{1} << 63);
+        break;
+      default:
+        // 有符号整数翻转符号位，NULL是最小值，变成0
+        v ^= uint64_t{1} << (8 * size - 1);
+        break;
+    }
+    StoreBigEndian(v, size, dst);
+  }
+
+  /** Decode one normalized column at src back into its tuple layout at dst. */
+  static inline void DecodeColumn(const char *src, TypeId type, char *dst) {
+    const size_t size = Type::GetTypeSize(type);
+    uint64_t v = LoadBigEndian(src, size);
+    switch (type) {
+      case TypeId::DECIMAL:
+        v = (v >> 63) != 0 ? v ^ (uint64_t{1} << 63) : ~v;
+        break;
+      default:
+        v ^= uint64_t{1} << (8 * size - 1);
+        break;
+    }
+    memcpy(dst, &v, size);
+  }
 };
 
 /**
@@ -77,6 +171,10 @@ template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
+    if (normalized_) {
+      return CompareNormalized(lhs.data_, rhs.data_);
+    }
+
     uint32_t column_count = key_schema_->GetColumnCount();
 
     for (uint32_t i = 0; i < column_count; i++) {
@@ -94,13 +192,59 @@ class GenericComparator {
     return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other)
+      : key_schema_{other.key_schema_}, normalized_{other.normalized_} {}
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema), normalized_(key_schema->IsInlined()) {}
+
+  /**
+   * Keys of 4 or 8 bytes, like a single INTEGER or BIGINT column, fit in an unsigned integer. If they are normalized,
+   * comparing those integers gives the same order as the comparator, see ToUnsigned().
+   */
+  static constexpr bool INTEGER_KEYS = KeySize == sizeof(uint32_t) || KeySize == sizeof(uint64_t);
+
+  /** @return true if the keys are normalized and compared byte by byte */
+  inline auto IsNormalized() const -> bool { return normalized_; }
+
+  /** @return the bytes of a normalized key as a big-endian unsigned integer, only for INTEGER_KEYS */
+  static inline auto ToUnsigned(const GenericKey<KeySize> &key) -> uint64_t {
+    static_assert(INTEGER_KEYS);
+    if constexpr (KeySize == sizeof(uint64_t)) {
+      uint64_t v;
+      memcpy(&v, key.data_, sizeof(v));
+      return __builtin_bswap64(v);
+    } else {
+      uint32_t v;
+      memcpy(&v, key.data_, sizeof(v));
+      return __builtin_bswap32(v);
+    }
+  }
 
  private:
+  /** Compare two normalized keys 8 bytes at a time, or with memcmp if KeySize is not a multiple of 8. */
+  static inline auto CompareNormalized(const char *lhs, const char *rhs) -> int {
+    if constexpr (KeySize % sizeof(uint64_t) == 0) {
+      for (size_t i = 0; i < KeySize; i += sizeof(uint64_t)) {
+        uint64_t l;
+        uint64_t r;
+        memcpy(&l, lhs + i, sizeof(l));
+        memcpy(&r, rhs + i, sizeof(r));
+        if (l != r) {
+          // 字节序转成大端再比，第一个不同的字节决定大小
+          return __builtin_bswap64(l) < __builtin_bswap64(r) ? -1 : 1;
+        }
+      }
+      return 0;
+    } else {
+      int cmp = memcmp(lhs, rhs, KeySize);
+      return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+    }
+  }
+
   Schema *key_schema_;
+  /** True if the keys are normalized, see GenericKey. */
+  bool normalized_;
 };
 
 }  // namespace bustub
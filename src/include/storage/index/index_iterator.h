@@ -14,18 +14,37 @@
  */
 #pragma once
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * Iterates over the entries of a B+ tree in key order, along the right links of the leaves.
+ *
+ * Between two steps the iterator keeps the current leaf pinned but not latched, and keeps a copy of the current entry.
+ * A step read latches the leaf again and goes on after the key of that entry: it moves right over leaves that were
+ * split since, and goes down from the root again if the entries after it were moved to a leaf on the left. So a scan
+ * running concurrently with inserts and removes returns every key that stays in the tree during the whole scan, once
+ * and in order, and never holds more than one leaf latch.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
   IndexIterator();
-  IndexIterator(BufferPoolManager *bpm, const B_PLUS_TREE_LEAF_PAGE_TYPE *page, int index, BasicPageGuard page_guard);
+  /**
+   * Start at the index-th entry of the read latched leaf, or at the first entry after the leaf if index is its size.
+   */
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm,
+                const KeyComparator *comparator, ReadPageGuard leaf_guard, int index);
   ~IndexIterator();  // NOLINT
+  IndexIterator(IndexIterator &&that) noexcept = default;
+  auto operator=(IndexIterator &&that) noexcept -> IndexIterator & = default;
 
   auto IsEnd() -> bool;
 
@@ -33,16 +52,33 @@ class IndexIterator {
 
   auto operator++() -> IndexIterator &;
 
-  auto operator==(const IndexIterator &itr) const -> bool { return (itr).page_ == page_ && (itr).index_ == index_; }
+  auto operator==(const IndexIterator &itr) const -> bool {
+    return (itr).page_id_ == page_id_ && (itr).index_ == index_;
+  }
 
-  auto operator!=(const IndexIterator &itr) const -> bool { return !((itr).page_ == page_ && (itr).index_ == index_); }
-  BasicPageGuard page_guard_;
+  auto operator!=(const IndexIterator &itr) const -> bool { return !(*this == itr); }
 
  private:
+  using LeafPage = B_PLUS_TREE_LEAF_PAGE_TYPE;
+
+  /** Stop at the index-th entry of the leaf, or follow the right links to the next entry if the leaf has no more. */
+  void Seek(ReadPageGuard leaf_guard, int index);
+
+  /** @return the index of the first entry of the leaf after the current entry */
+  auto IndexAfterItem(const LeafPage *leaf_page) const -> int;
+
+  /** Prefetch the leaves after the current leaf if it is time to, see scan_read_ahead_pages. */
+  void ReadAhead(page_id_t next_page_id);
+
   // add your own private member variables here
-  const B_PLUS_TREE_LEAF_PAGE_TYPE *page_{nullptr};  // 所在的页面
-  int index_{INVALID_PAGE_ID};                       // 索引
-  BufferPoolManager *bpm_{nullptr};                  // 方面读取下一个页面
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};  // 叶子被合并掉了要从根重新找
+  BufferPoolManager *bpm_{nullptr};                               // 方面读取下一个页面
+  const KeyComparator *comparator_{nullptr};
+  BasicPageGuard page_guard_;           // pin住所在的页面，不加锁
+  page_id_t page_id_{INVALID_PAGE_ID};  // 所在的页面
+  int index_{-1};                       // 索引，只用来判断两个迭代器相不相等
+  MappingType item_;                    // 当前条目的拷贝，下一步从它的key往后找
+  size_t pages_until_read_ahead_{0};    // 还要走过多少个页面才再次预读
 };
 
 }  // namespace bustub
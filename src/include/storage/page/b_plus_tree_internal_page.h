@@ -18,7 +18,7 @@
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 12
+#define INTERNAL_PAGE_HEADER_SIZE (20 + 2 * sizeof(KeyType))
 #define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
@@ -32,6 +32,12 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * Header format (size in byte, 20 bytes + two keys in total), like the leaf page the internal page links to its right
+ * sibling so that readers can move right after a concurrent split (Lehman-Yao B-link tree):
+ *  ---------------------------------------------------------------------------------------------------------
+ * | PageType (4) | CurrentSize (4) | MaxSize (4) | NextPageId (4) | HasLowKey (4) | LowKey | HighKey |
+ *  ---------------------------------------------------------------------------------------------------------
  * 说明这个value指向的是另外一个页
  */
 INDEX_TEMPLATE_ARGUMENTS
@@ -48,6 +54,26 @@ class BPlusTreeInternalPage : public BPlusTreePage {
    */
   void Init(int max_size = INTERNAL_PAGE_SIZE);
 
+  // 右兄弟的页号，最右边的页面是INVALID_PAGE_ID
+  auto GetNextPageId() const -> page_id_t;
+  void SetNextPageId(page_id_t next_page_id);
+  /**
+   * B-link fence keys: every key in the page is in [low key, high key), and the high key is the low key of the right
+   * sibling. The leftmost page of a level has no low key, the rightmost page has no right sibling and no high key.
+   */
+  auto HasLowKey() const -> bool;
+  auto GetLowKey() const -> KeyType;
+  void SetLowKey(const KeyType &key);
+  auto GetHighKey() const -> KeyType;
+  void SetHighKey(const KeyType &key);
+  /**
+   * @return -1 if key is below the low key, i.e. it was moved to a page on the left; 1 if key is at or above the high
+   * key, i.e. it was moved to the right sibling by a split; 0 if key belongs to this page
+   */
+  auto CompareToFences(const KeyType &key, const KeyComparator &comparator) const -> int;
+  // 分裂出右兄弟之后接上右链：右兄弟接过自己原来的high key和next，separator成为两边的分界
+  void LinkRightSibling(BPlusTreeInternalPage *sibling, page_id_t sibling_page_id, const KeyType &separator);
+
   /**
    * @param index The index of the key to get. Index must be non-zero.
    * @return Key at index
@@ -77,6 +103,14 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   auto ValueAt(int index) const -> ValueType;
   // 给定键，找对其对应的下一级页面的id
   auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> int;
+  /**
+   * @brief Find the child that may contain key. Safe to call while a writer modifies the page, for optimistic readers
+   * (see OptimisticReadGuard): the result is garbage then, but no access goes past the end of the page.
+   *
+   * @param[out] child the child that may contain key
+   * @return false if the page does not look like a valid internal page
+   */
+  auto FindChild(const KeyType &key, const KeyComparator &comparator, ValueType *child) const -> bool;
   // 给内部页面的添加第一个元素
   void InsertFirstOf(const page_id_t &value);
   // 在内部页面中插入数据
@@ -93,6 +127,8 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   auto RemoveKeyAt(const KeyType &key, const KeyComparator &comparator) -> bool;
 
   void MoveAllTo(B_PLUS_TREE_INTERNAL_PAGE_TYPE *recipient);
+  // 追加到最后，调用者保证key比页面里所有的key都大，批量建树用
+  void Append(const KeyType &key, const page_id_t &value);
 
   /**
    * @brief For test only, return a string representing all keys in
@@ -121,6 +157,13 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   }
 
  private:
+  // 在前size个元素里二分查找
+  auto Lookup(const KeyType &key, const KeyComparator &comparator, int size) const -> int;
+
+  page_id_t next_page_id_;
+  int has_low_key_;
+  KeyType low_key_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[0];  // 键值对 pair<KeyType, ValueType>，可以根据.first访问key，second访问value，这里面存储数据
 };
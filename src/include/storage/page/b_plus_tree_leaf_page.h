@@ -19,7 +19,7 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 16
+#define LEAF_PAGE_HEADER_SIZE (20 + 2 * sizeof(KeyType))
 #define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 /**
@@ -33,13 +33,13 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 16 bytes in total):
+ *  Header format (size in byte, 20 bytes + two keys in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * |  NextPageId (4)
- *  -----------------------------------------------
+ *  -----------------------------------------------------------------
+ * |  NextPageId (4) | HasLowKey (4) | LowKey | HighKey
+ *  -----------------------------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -58,9 +58,33 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  /**
+   * B-link fence keys: every key in the page is in [low key, high key), and the high key is the low key of the right
+   * sibling. The leftmost page of a level has no low key, the rightmost page has no right sibling and no high key.
+   */
+  auto HasLowKey() const -> bool;
+  auto GetLowKey() const -> KeyType;
+  void SetLowKey(const KeyType &key);
+  auto GetHighKey() const -> KeyType;
+  void SetHighKey(const KeyType &key);
+  /**
+   * @return -1 if key is below the low key, i.e. it was moved to a page on the left; 1 if key is at or above the high
+   * key, i.e. it was moved to the right sibling by a split; 0 if key belongs to this page
+   */
+  auto CompareToFences(const KeyType &key, const KeyComparator &comparator) const -> int;
+  // 分裂出右兄弟之后接上右链：右兄弟接过自己原来的high key和next，separator成为两边的分界
+  void LinkRightSibling(BPlusTreeLeafPage *sibling, page_id_t sibling_page_id, const KeyType &separator);
   auto KeyAt(int index) const -> KeyType;
   auto ValueAt(int index) const -> ValueType;
   auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> int;
+  /**
+   * @brief Find the value of key. Safe to call while a writer modifies the page, for optimistic readers (see
+   * OptimisticReadGuard): the result is garbage then, but no access goes past the end of the page.
+   *
+   * @param[out] value the value of key, if found
+   * @return true if key is in the page
+   */
+  auto FindValue(const KeyType &key, const KeyComparator &comparator, ValueType *value) const -> bool;
   auto Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) -> int;
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
@@ -68,6 +92,8 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   auto RemoveKeyAt(const KeyType &key, const KeyComparator &comparator) -> bool;
   void RemoveAt(int index);
   void MoveAllTo(B_PLUS_TREE_LEAF_PAGE_TYPE *recipient);
+  // 追加到最后，调用者保证key比页面里所有的key都大，批量建树用
+  void Append(const KeyType &key, const ValueType &value);
   auto GetObjAt(int index) const -> const MappingType &;
   /**
    * @brief for test only return a string representing all keys in
@@ -95,7 +121,13 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   }
 
  private:
+  // 在前size个元素里二分查找
+  auto Lookup(const KeyType &key, const KeyComparator &comparator, int size) const -> int;
+
   page_id_t next_page_id_;  // 这里面还指向了下一个页面id，毕竟叶子节点存储真实的数据，需要更多的页存储
+  int has_low_key_;
+  KeyType low_key_;
+  KeyType high_key_;
   // Flexible array member for page data.
   MappingType array_[0];
 };
@@ -47,6 +47,8 @@ class BPlusTreePage {
 
   auto IsLeafPage() const -> bool;
   void SetPageType(IndexPageType page_type);
+  // 合并掉的页面会被标成INVALID_INDEX_PAGE，不加父页面的锁往下走的读者可能还pin着它，看到了就要从根重新找
+  auto IsDeleted() const -> bool;
 
   auto GetSize() const -> int;
   void SetSize(int size);
@@ -63,4 +65,53 @@ class BPlusTreePage {
   int max_size_ __attribute__((__unused__));
 };
 
+/** Number of keys that KeyLowerBound() compares one by one after narrowing the range down. */
+static constexpr int KEY_SEARCH_WINDOW = 8;
+
+/**
+ * Search the sorted keys of the entries of a B+ tree page.
+ *
+ * Integer keys (see GenericComparator::INTEGER_KEYS) are compared as unsigned integers instead of through the
+ * comparator. A binary search without branches narrows the range down to KEY_SEARCH_WINDOW keys, and then the keys less
+ * than key are counted, again without branches. Other keys use a plain binary search with the comparator.
+ *
+ * @param array the entries, pairs whose first is the key
+ * @return the index of the first entry in [begin, end) whose key is not less than key, or end if there is none
+ */
+template <typename Entry, typename KeyType, typename KeyComparator>
+auto KeyLowerBound(const Entry *array, int begin, int end, const KeyType &key, const KeyComparator &comparator)
+    -> int {
+  if constexpr (KeyComparator::INTEGER_KEYS) {
+    if (comparator.IsNormalized()) {
+      const uint64_t target = KeyComparator::ToUnsigned(key);
+      const Entry *base = array + begin;
+      int n = end - begin;
+      // 答案一直在[base, base + n]里
+      while (n > KEY_SEARCH_WINDOW) {
+        int half = n / 2;
+        base = KeyComparator::ToUnsigned(base[half].first) < target ? base + half : base;
+        n -= half;
+      }
+      int index = static_cast<int>(base - array);
+      for (int i = 0; i < n; i++) {
+        index += static_cast<int>(KeyComparator::ToUnsigned(base[i].first) < target);
+      }
+      return index;
+    }
+  }
+  int l = begin;
+  int r = end - 1;
+  int ans = end;
+  while (l <= r) {
+    int mid = (l + r) >> 1;
+    if (comparator(array[mid].first, key) >= 0) {
+      ans = mid;
+      r = mid - 1;
+    } else {
+      l = mid + 1;
+    }
+  }
+  return ans;
+}
+
 }  // namespace bustub
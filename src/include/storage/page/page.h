@@ -12,6 +12,9 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>  // NOLINT
 #include <cstring>
 #include <iostream>
 
@@ -31,13 +34,23 @@ class Page {
 
  public:
   /** Constructor. Zeros out the page data. */
-  Page() {
+  Page() : owns_data_(true) {
     data_ = new char[BUSTUB_PAGE_SIZE];
     ResetMemory();
   }
 
+  /**
+   * Constructor for a page whose data lives in memory owned by someone else, e.g. the frame arena of the buffer pool.
+   * The data must be BUSTUB_PAGE_SIZE bytes, already zeroed, and outlive the page.
+   */
+  explicit Page(char *data) : data_(data), owns_data_(false) {}
+
   /** Default destructor. */
-  ~Page() { delete[] data_; }
+  ~Page() {
+    if (owns_data_) {
+      delete[] data_;
+    }
+  }
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -46,7 +59,7 @@ class Page {
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int { return std::max(pin_count_.load(), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
@@ -63,6 +76,18 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** Try to turn the page read latch held by the caller into the write latch, see ReaderWriterLatch::TryUpgrade(). */
+  inline auto TryUpgradeLatch() -> bool { return rwlatch_.TryUpgrade(); }
+
+  /** Turn the page write latch held by the caller into a read latch, see ReaderWriterLatch::Downgrade(). */
+  inline void DowngradeLatch() { rwlatch_.Downgrade(); }
+
+  /** @return the version of the page latch, see ReaderWriterLatch. Odd while the write latch is held. */
+  inline auto GetVersion() const -> uint64_t { return rwlatch_.Version(); }
+
+  /** @return true if the write latch was not taken since GetVersion() returned `version` */
+  inline auto ValidateVersion(uint64_t version) const -> bool { return rwlatch_.Validate(version); }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -85,12 +110,29 @@ class Page {
   // Usually this should be stored as `char data_[BUSTUB_PAGE_SIZE]{};`. But to enable ASAN to detect page overflow,
   // we store it as a ptr.
   char *data_;
+  /** False if data_ points into memory owned by someone else. */
+  bool owns_data_;
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /**
+   * The pin count of this page. Buffer pool hits pin a page without the buffer pool latch, so this is atomic, and -1
+   * while the frame is free or being taken over by the buffer pool: a frame can only be pinned while it is not -1.
+   */
+  std::atomic<int> pin_count_{0};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /**
+   * True while the buffer pool is reading this page from disk (or writing back the page that previously lived in this
+   * frame). Only changed under the buffer pool latch; requesters of this page wait on io_cv_ until it is cleared.
+   */
+  std::atomic<bool> io_in_progress_{false};
+  /**
+   * True if the buffer pool told the replacer that the frame is not evictable because it was pinned. Protected by the
+   * buffer pool latch.
+   */
+  bool parked_ = false;
+  /** Signalled by the buffer pool when the in-flight I/O on this frame completes. */
+  std::condition_variable_any io_cv_;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;  // 页面锁
 };
@@ -5,6 +5,8 @@
 namespace bustub {
 
 class BufferPoolManager;
+class ReadPageGuard;
+class WritePageGuard;
 
 class BasicPageGuard {
  public:
@@ -80,10 +82,17 @@ class BasicPageGuard {
     // 将这个指针变成head_page类型的，方便页面进行写数据
   }
 
+  /**
+   * @brief Take the read latch of the page and turn this guard into a ReadPageGuard. The page stays pinned while the
+   * latch is awaited, so it cannot be evicted or deleted in between. This guard is empty afterwards.
+   */
+  auto UpgradeRead() -> ReadPageGuard;
+
  private:
   friend class ReadPageGuard;
   // 首先这个类是Read和write的私有属性（注意他们没有继承basic），所以要访问属性的私有部分就需要友元
   friend class WritePageGuard;
+  friend class OptimisticReadGuard;
 
   [[maybe_unused]] BufferPoolManager *bpm_{nullptr};  // 有一个缓冲池管理
   Page *page_{nullptr};                               // 一个页面
@@ -145,7 +154,30 @@ class ReadPageGuard {
     return guard_.As<T>();
   }
 
+  /**
+   * @brief Try to turn this guard into a WritePageGuard of the same page, keeping the pin.
+   *
+   * Does not block: fails if any other thread holds or waits for the latch of the page. On success this guard is empty
+   * and no writer modified the page since the read latch was taken, so what was read through this guard is still
+   * valid. On failure this guard still holds the read latch, and the caller can drop it and fall back to fetching the
+   * page for writing.
+   *
+   * @param[out] write_guard the guard that holds the write latch on success
+   * @return true if the latch was upgraded
+   */
+  auto TryUpgrade(WritePageGuard *write_guard) -> bool;
+
+  /**
+   * @brief Release the read latch but keep the page pinned, e.g. to come back to the page later without it being
+   * deleted. This guard is empty afterwards.
+   */
+  auto Downgrade() -> BasicPageGuard;
+
  private:
+  friend class BasicPageGuard;
+  friend class OptimisticReadGuard;
+  friend class WritePageGuard;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
@@ -212,9 +244,63 @@ class WritePageGuard {
     return guard_.AsMut<T>();
   }
 
+  /**
+   * @brief Turn this guard into a ReadPageGuard of the same page, keeping the pin and the dirty flag. No other writer
+   * can modify the page in between. This guard is empty afterwards.
+   */
+  auto Downgrade() -> ReadPageGuard;
+
  private:
+  friend class ReadPageGuard;
+
   // You may choose to get rid of this and add your own private variables.
   BasicPageGuard guard_;
 };
 
+/**
+ * OptimisticReadGuard pins a page without taking its latch. It remembers the version of the page latch when it was
+ * created, and Validate() tells whether a writer latched the page since then.
+ *
+ * Data read through the guard may be torn by a concurrent writer, so it must only be trusted after Validate() returned
+ * true, and reading it must not go out of bounds whatever its content is (e.g. check sizes before indexing).
+ */
+class OptimisticReadGuard {
+ public:
+  OptimisticReadGuard() = default;
+  OptimisticReadGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page), version_(page->GetVersion()) {}
+  OptimisticReadGuard(const OptimisticReadGuard &) = delete;
+  auto operator=(const OptimisticReadGuard &) -> OptimisticReadGuard & = delete;
+
+  OptimisticReadGuard(OptimisticReadGuard &&that) noexcept;
+
+  auto operator=(OptimisticReadGuard &&that) noexcept -> OptimisticReadGuard &;
+
+  /** @brief Unpin the page. */
+  void Drop();
+
+  ~OptimisticReadGuard();
+
+  auto PageId() -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() -> const T * {
+    return guard_.As<T>();
+  }
+
+  /** @return true if no writer latched the page since the guard was created */
+  auto Validate() const -> bool { return guard_.page_->ValidateVersion(version_); }
+
+  /**
+   * @brief Take the read latch of the page and turn this guard into a ReadPageGuard, for readers that gave up on
+   * optimistic reads. The page stays pinned, this guard is empty afterwards.
+   */
+  auto Lock() -> ReadPageGuard;
+
+ private:
+  BasicPageGuard guard_;
+  uint64_t version_{0};
+};
+
 }  // namespace bustub
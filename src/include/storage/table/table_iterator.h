@@ -55,6 +55,12 @@ class TableIterator {
   // Otherwise we will have dead loops when updating while scanning. (In project 4, update should be implemented as
   // deletion + insertion.)
   RID stop_at_rid_;
+
+  /** Number of pages left to cross before the next read-ahead request. */
+  size_t pages_until_read_ahead_{0};
+
+  /** Prefetch the pages after the current page if it is time to, see scan_read_ahead_pages. */
+  void ReadAhead(page_id_t next_page_id);
 };
 
 }  // namespace bustub
@@ -11,7 +11,9 @@
 //===----------------------------------------------------------------------===//
 
 #include <sys/stat.h>
+#include <algorithm>
 #include <cassert>
+#include <chrono>  // NOLINT
 #include <cstring>
 #include <iostream>
 #include <mutex>  // NOLINT
@@ -31,10 +33,41 @@ static char *buffer_used;
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+  if (!OpenLog()) {
+    return;
+  }
+
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+  // directory or file does not exist
+  if (!db_io_.is_open()) {
+    db_io_.clear();
+    // create a new file
+    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+    if (!db_io_.is_open()) {
+      throw Exception("can't open db file");
+    }
+  }
+  free_page_map_ =
+      std::make_unique<FreePageMap>(this, std::max(GetFileSize(db_file), 0) / BUSTUB_PAGE_SIZE, true);
+  buffer_used = nullptr;
+}
+
+DiskManager::~DiskManager() {
+  // 派生类的析构函数已经写回了自己的空闲页位图，这里只剩下数据库文件还开着的DiskManager
+  if (db_io_.is_open()) {
+    free_page_map_->Flush();
+  }
+}
+
+/**
+ * Open/create the log file, named after the database file
+ */
+auto DiskManager::OpenLog() -> bool {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
-    return;
+    return false;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
 
@@ -48,25 +81,14 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
       throw Exception("can't open dblog file");
     }
   }
-
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
-    }
-  }
-  buffer_used = nullptr;
+  return true;
 }
 
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  free_page_map_->Flush();
   {
     std::scoped_lock scoped_db_io_latch(db_io_latch_);
     db_io_.close();
@@ -79,6 +101,7 @@ void DiskManager::ShutDown() {
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  const auto start = std::chrono::steady_clock::now();
   size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
   // set write cursor to offset
   num_writes_ += 1;
@@ -91,6 +114,7 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   }
   // needs to flush to keep disk file in sync
   db_io_.flush();
+  RecordWrites(1, 1, std::chrono::steady_clock::now() - start);
 }
 
 /**
@@ -122,6 +146,48 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
   }
 }
 
+/**
+ * Write the pages one by one, in page id order
+ */
+void DiskManager::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  std::sort(pages.begin(), pages.end());
+  for (const auto &[page_id, page_data] : pages) {
+    WritePage(page_id, page_data);
+  }
+}
+
+/**
+ * WritePage() already flushes the stream after every page, so this only counts the sync
+ */
+void DiskManager::Sync() {
+  std::scoped_lock scoped_db_io_latch(db_io_latch_);
+  const auto start = std::chrono::steady_clock::now();
+  db_io_.flush();
+  RecordSync(std::chrono::steady_clock::now() - start);
+}
+
+auto DiskManager::GetStats() const -> DiskManagerStats {
+  DiskManagerStats stats;
+  stats.pages_written_ = pages_written_.Load();
+  stats.bytes_written_ = stats.pages_written_ * BUSTUB_PAGE_SIZE;
+  stats.write_calls_ = write_calls_.Load();
+  stats.write_ns_ = write_ns_.Load();
+  stats.syncs_ = syncs_.Load();
+  stats.sync_ns_ = sync_ns_.Load();
+  return stats;
+}
+
+void DiskManager::RecordWrites(size_t num_pages, size_t num_calls, std::chrono::nanoseconds elapsed) {
+  pages_written_.Add(num_pages);
+  write_calls_.Add(num_calls);
+  write_ns_.Add(elapsed.count());
+}
+
+void DiskManager::RecordSync(std::chrono::nanoseconds elapsed) {
+  syncs_.Add();
+  sync_ns_.Add(elapsed.count());
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
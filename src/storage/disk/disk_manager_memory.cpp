@@ -16,6 +16,8 @@
 #include <cstddef>
 #include <cstring>
 #include <iostream>
+#include <mutex>  // NOLINT
+#include <shared_mutex>
 #include <string>
 #include <thread>  // NOLINT
 
@@ -47,4 +49,81 @@ void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
   memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
 }
 
+DiskManagerUnlimitedMemory::~DiskManagerUnlimitedMemory() {
+  for (auto &slot : directory_) {
+    Segment *segment = slot.load(std::memory_order_relaxed);
+    if (segment == nullptr) {
+      continue;
+    }
+    for (auto &page : *segment) {
+      delete page.load(std::memory_order_relaxed);
+    }
+    delete segment;
+  }
+}
+
+auto DiskManagerUnlimitedMemory::FindPage(page_id_t page_id) const -> ProtectedPage * {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= DIRECTORY_SEGMENTS * SEGMENT_PAGES) {
+    return nullptr;
+  }
+  // acquire配合安装时的CAS，拿到指针就能看到初始化好的段和页面
+  Segment *segment = directory_[page_id / SEGMENT_PAGES].load(std::memory_order_acquire);
+  if (segment == nullptr) {
+    return nullptr;
+  }
+  return (*segment)[page_id % SEGMENT_PAGES].load(std::memory_order_acquire);
+}
+
+auto DiskManagerUnlimitedMemory::FindOrCreatePage(page_id_t page_id) -> ProtectedPage * {
+  if (page_id < 0 || static_cast<size_t>(page_id) >= DIRECTORY_SEGMENTS * SEGMENT_PAGES) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "page id out of range of DiskManagerUnlimitedMemory");
+  }
+  auto &segment_slot = directory_[page_id / SEGMENT_PAGES];
+  Segment *segment = segment_slot.load(std::memory_order_acquire);
+  if (segment == nullptr) {
+    // 两个线程同时装同一个段，CAS输的那个把自己的删掉，用赢的那个
+    auto *fresh = new Segment{};
+    if (segment_slot.compare_exchange_strong(segment, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      segment = fresh;
+    } else {
+      delete fresh;
+    }
+  }
+  auto &page_slot = (*segment)[page_id % SEGMENT_PAGES];
+  ProtectedPage *page = page_slot.load(std::memory_order_acquire);
+  if (page == nullptr) {
+    auto *fresh = new ProtectedPage();
+    if (page_slot.compare_exchange_strong(page, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      page = fresh;
+    } else {
+      delete fresh;
+    }
+  }
+  return page;
+}
+
+void DiskManagerUnlimitedMemory::WritePage(page_id_t page_id, const char *page_data) {
+  if (latency_ > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
+  }
+
+  ProtectedPage *page = FindOrCreatePage(page_id);
+  std::unique_lock<std::shared_mutex> l_page(page->latch_);
+  memcpy(page->data_.data(), page_data, BUSTUB_PAGE_SIZE);
+}
+
+void DiskManagerUnlimitedMemory::ReadPage(page_id_t page_id, char *page_data) {
+  if (latency_ > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(latency_));
+  }
+
+  ProtectedPage *page = FindPage(page_id);
+  if (page == nullptr) {
+    LOG_WARN("page not exist");
+    return;
+  }
+  std::shared_lock<std::shared_mutex> l_page(page->latch_);
+  memcpy(page_data, page->data_.data(), BUSTUB_PAGE_SIZE);
+}
+
 }  // namespace bustub
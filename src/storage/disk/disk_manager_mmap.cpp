@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <string>
+
+#include "buffer/replacer.h"
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file) {
+  file_name_ = db_file;
+  fd_ = open(db_file.c_str(), O_RDONLY);
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  Remap();
+}
+
+DiskManagerMmap::~DiskManagerMmap() { ShutDown(); }
+
+void DiskManagerMmap::ShutDown() {
+  const std::unique_lock<std::shared_mutex> guard(mapping_latch_);
+  if (data_ != nullptr) {
+    munmap(data_, mapped_size_);
+    data_ = nullptr;
+    mapped_size_ = 0;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
+  }
+}
+
+void DiskManagerMmap::WritePage(page_id_t page_id, const char *page_data) {
+  throw Exception(ExceptionType::INVALID, "DiskManagerMmap is read-only, cannot write page " + std::to_string(page_id));
+}
+
+/**
+ * Copy the page out of the mapping; the part of the page past the end of the file reads as zeros
+ */
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  const size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  std::shared_lock<std::shared_mutex> lock(mapping_latch_);
+  if (offset + BUSTUB_PAGE_SIZE > mapped_size_) {
+    // 文件可能变大了，重新映射一下再看
+    lock.unlock();
+    Remap();
+    lock.lock();
+  }
+  size_t read_count = 0;
+  if (offset < mapped_size_) {
+    read_count = std::min<size_t>(BUSTUB_PAGE_SIZE, mapped_size_ - offset);
+    memcpy(page_data, data_ + offset, read_count);
+  } else {
+    LOG_DEBUG("I/O error reading past end of file");
+  }
+  memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+}
+
+void DiskManagerMmap::AdviseAccess(page_id_t page_id, AccessType access_type) {
+  if (page_id < 0 || (access_type != AccessType::Scan && access_type != AccessType::Prefetch)) {
+    return;
+  }
+  size_t num_pages = 1;
+  if (access_type == AccessType::Scan) {
+    // 扫描的时候一次建议一整个窗口，扫描走到窗口的后一半再从当前页建议下一个窗口，不用每页都调一次madvise
+    const page_id_t advised_until = scan_advised_until_.load(std::memory_order_relaxed);
+    const auto window = static_cast<page_id_t>(SCAN_READAHEAD_PAGES);
+    if (page_id >= advised_until - window && page_id < advised_until - window / 2) {
+      return;
+    }
+    num_pages = SCAN_READAHEAD_PAGES;
+    scan_advised_until_.store(page_id + static_cast<page_id_t>(num_pages), std::memory_order_relaxed);
+  }
+
+  const std::shared_lock<std::shared_mutex> guard(mapping_latch_);
+  const size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  if (offset >= mapped_size_) {
+    return;
+  }
+  const size_t length = std::min(num_pages * BUSTUB_PAGE_SIZE, mapped_size_ - offset);
+  if (access_type == AccessType::Scan) {
+    madvise(data_ + offset, length, MADV_SEQUENTIAL);
+  }
+  madvise(data_ + offset, length, MADV_WILLNEED);
+}
+
+auto DiskManagerMmap::GetMappedSize() -> size_t {
+  const std::shared_lock<std::shared_mutex> guard(mapping_latch_);
+  return mapped_size_;
+}
+
+void DiskManagerMmap::Remap() {
+  const std::unique_lock<std::shared_mutex> guard(mapping_latch_);
+  struct stat stat_buf;
+  if (fd_ < 0 || fstat(fd_, &stat_buf) != 0) {
+    return;
+  }
+  const auto file_size = static_cast<size_t>(stat_buf.st_size);
+  // 另一个线程可能已经重新映射过了
+  if (file_size <= mapped_size_) {
+    return;
+  }
+  void *data = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd_, 0);
+  if (data == MAP_FAILED) {
+    LOG_DEBUG("failed to map the db file");
+    return;
+  }
+  madvise(data, file_size, MADV_RANDOM);
+  if (data_ != nullptr) {
+    munmap(data_, mapped_size_);
+  }
+  data_ = static_cast<char *>(data);
+  mapped_size_ = file_size;
+}
+
+}  // namespace bustub
@@ -0,0 +1,239 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_posix.cpp
+//
+// Identification: src/storage/disk/disk_manager_posix.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_posix.h"
+
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+auto IsPageAligned(const char *data) -> bool { return reinterpret_cast<uintptr_t>(data) % BUSTUB_PAGE_SIZE == 0; }
+
+/** Each thread bounces unaligned pages through its own aligned buffer, so direct I/O needs no latch either. */
+auto BounceBuffer() -> char * {
+  alignas(BUSTUB_PAGE_SIZE) static thread_local char buffer[BUSTUB_PAGE_SIZE];
+  return buffer;
+}
+
+}  // namespace
+
+DiskManagerPosix::DiskManagerPosix(const std::string &db_file, bool direct_io) {
+  file_name_ = db_file;
+  if (!OpenLog()) {
+    return;
+  }
+
+  const int flags = O_RDWR | O_CREAT;
+#ifdef O_DIRECT
+  if (direct_io) {
+    fd_ = open(db_file.c_str(), flags | O_DIRECT, 0644);
+    // tmpfs之类的文件系统不支持O_DIRECT，退回到普通的读写
+    direct_io_ = fd_ >= 0;
+  }
+#endif
+  if (fd_ < 0) {
+    fd_ = open(db_file.c_str(), flags, 0644);
+  }
+  if (fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+#if defined(__APPLE__) && defined(F_NOCACHE)
+  if (direct_io) {
+    direct_io_ = fcntl(fd_, F_NOCACHE, 1) == 0;
+  }
+#endif
+
+  struct stat stat_buf;
+  if (fstat(fd_, &stat_buf) != 0) {
+    close(fd_);
+    fd_ = -1;
+    throw Exception("can't stat db file");
+  }
+  file_size_.store(stat_buf.st_size, std::memory_order_release);
+  free_page_map_ = std::make_unique<FreePageMap>(this, stat_buf.st_size / BUSTUB_PAGE_SIZE, true);
+}
+
+DiskManagerPosix::~DiskManagerPosix() {
+  if (fd_ >= 0) {
+    free_page_map_->Flush();
+    close(fd_);
+  }
+}
+
+void DiskManagerPosix::ShutDown() {
+  if (fd_ >= 0) {
+    free_page_map_->Flush();
+    close(fd_);
+    fd_ = -1;
+  }
+  log_io_.close();
+}
+
+/**
+ * Write the contents of the specified page into disk file
+ */
+void DiskManagerPosix::WritePage(page_id_t page_id, const char *page_data) {
+  const auto start = std::chrono::steady_clock::now();
+  const auto offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  const char *buffer = page_data;
+  if (direct_io_ && !IsPageAligned(page_data)) {
+    char *bounce = BounceBuffer();
+    memcpy(bounce, page_data, BUSTUB_PAGE_SIZE);
+    buffer = bounce;
+  }
+  num_writes_ += 1;
+
+  size_t written = 0;
+  while (written < BUSTUB_PAGE_SIZE) {
+    ssize_t rc = pwrite(fd_, buffer + written, BUSTUB_PAGE_SIZE - written, offset + written);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written += rc;
+  }
+  RecordWrites(1, 1, std::chrono::steady_clock::now() - start);
+  GrowFileSize(offset + BUSTUB_PAGE_SIZE);
+}
+
+/**
+ * Write the pages in page id order, one pwritev per run of adjacent pages
+ */
+void DiskManagerPosix::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  std::sort(pages.begin(), pages.end());
+  std::vector<iovec> iovs;
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  auto flush_run = [&] {
+    if (!iovs.empty() && !WriteRun(first_page_id, std::move(iovs))) {
+      LOG_DEBUG("I/O error while writing");
+    }
+    iovs.clear();
+  };
+  for (const auto &[page_id, page_data] : pages) {
+    // O_DIRECT下没对齐的页面走WritePage()，经过对齐的缓冲区
+    if (direct_io_ && !IsPageAligned(page_data)) {
+      flush_run();
+      WritePage(page_id, page_data);
+      continue;
+    }
+    if (iovs.empty() || page_id != first_page_id + static_cast<page_id_t>(iovs.size()) || iovs.size() == IOV_MAX) {
+      flush_run();
+      first_page_id = page_id;
+    }
+    iovs.push_back({const_cast<char *>(page_data), BUSTUB_PAGE_SIZE});
+  }
+  flush_run();
+}
+
+auto DiskManagerPosix::WriteRun(page_id_t first_page_id, std::vector<iovec> iovs) -> bool {
+  const auto start = std::chrono::steady_clock::now();
+  const size_t num_pages = iovs.size();
+  const auto offset = static_cast<off_t>(first_page_id) * BUSTUB_PAGE_SIZE;
+  size_t num_calls = 0;
+  size_t written = 0;
+  size_t next_iov = 0;
+  while (next_iov < iovs.size()) {
+    ssize_t rc = pwritev(fd_, &iovs[next_iov], static_cast<int>(iovs.size() - next_iov), offset + written);
+    num_calls++;
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      return false;
+    }
+    // 只写了一部分的话，跳过写完的iovec，从断开的地方接着写
+    written += rc;
+    auto remaining = static_cast<size_t>(rc);
+    while (remaining > 0 && remaining >= iovs[next_iov].iov_len) {
+      remaining -= iovs[next_iov].iov_len;
+      next_iov++;
+    }
+    if (remaining > 0) {
+      iovs[next_iov].iov_base = static_cast<char *>(iovs[next_iov].iov_base) + remaining;
+      iovs[next_iov].iov_len -= remaining;
+    }
+  }
+  num_writes_ += num_pages;
+  RecordWrites(num_pages, num_calls, std::chrono::steady_clock::now() - start);
+  GrowFileSize(offset + static_cast<int64_t>(written));
+  return true;
+}
+
+void DiskManagerPosix::Sync() {
+  const auto start = std::chrono::steady_clock::now();
+  while (fsync(fd_) != 0) {
+    if (errno != EINTR) {
+      LOG_DEBUG("I/O error while syncing");
+      return;
+    }
+  }
+  RecordSync(std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Read the contents of the specified page into the given memory area
+ */
+void DiskManagerPosix::ReadPage(page_id_t page_id, char *page_data) {
+  const auto offset = static_cast<off_t>(page_id) * BUSTUB_PAGE_SIZE;
+  // 文件大小在内存里，不用每次读都stat一下
+  if (offset >= file_size_.load(std::memory_order_acquire)) {
+    LOG_DEBUG("I/O error reading past end of file");
+    memset(page_data, 0, BUSTUB_PAGE_SIZE);
+    return;
+  }
+  char *buffer = direct_io_ && !IsPageAligned(page_data) ? BounceBuffer() : page_data;
+
+  size_t read_count = 0;
+  while (read_count < BUSTUB_PAGE_SIZE) {
+    ssize_t rc = pread(fd_, buffer + read_count, BUSTUB_PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      LOG_DEBUG("I/O error while reading");
+      break;
+    }
+    if (rc == 0) {
+      // if file ends before reading BUSTUB_PAGE_SIZE
+      LOG_DEBUG("Read less than a page");
+      break;
+    }
+    read_count += rc;
+  }
+  memset(buffer + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+  if (buffer != page_data) {
+    memcpy(page_data, buffer, BUSTUB_PAGE_SIZE);
+  }
+}
+
+void DiskManagerPosix::GrowFileSize(int64_t size) {
+  int64_t current = file_size_.load(std::memory_order_relaxed);
+  while (current < size && !file_size_.compare_exchange_weak(current, size, std::memory_order_release)) {
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,344 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <sys/uio.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <exception>
+#include <utility>
+
+#include "common/logger.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager_posix.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BUSTUB_HAVE_IO_URING 1
+#endif
+
+namespace bustub {
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+/**
+ * A minimal io_uring, set up with the raw system calls so that no liburing is needed. Any thread can submit, holding
+ * latch_; one reaper thread waits for the completions and sets the callbacks.
+ */
+class DiskScheduler::IoUring {
+ public:
+  /** @return the ring, or nullptr if the kernel does not support io_uring */
+  static auto Create(DiskManagerPosix *disk_manager, size_t queue_depth) -> std::unique_ptr<IoUring> {
+    io_uring_params params{};
+    const int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(queue_depth), &params));
+    if (ring_fd < 0) {
+      return nullptr;
+    }
+    std::unique_ptr<IoUring> ring(new IoUring(disk_manager, ring_fd, queue_depth));
+    if (!ring->Map(params)) {
+      return nullptr;
+    }
+    ring->reaper_ = std::thread(&IoUring::ReapLoop, ring.get());
+    return ring;
+  }
+
+  ~IoUring() {
+    if (reaper_.joinable()) {
+      // user_data为0的NOP是让reaper退出的信号，它会先等在途的请求都完成
+      std::unique_lock<std::mutex> lock(latch_);
+      io_uring_sqe *sqe = NextSqe();
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = 0;
+      SubmitOne();
+      lock.unlock();
+      reaper_.join();
+    }
+    if (sq_ptr_ != nullptr) {
+      munmap(sq_ptr_, sq_size_);
+    }
+    if (cq_ptr_ != nullptr && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_size_);
+    }
+    if (sqes_ != nullptr) {
+      munmap(sqes_, sqes_size_);
+    }
+    close(ring_fd_);
+  }
+
+  void Submit(DiskRequest r) {
+    auto *pending = new Pending{std::move(r), {}, std::chrono::steady_clock::now()};
+    pending->iov_.iov_base = pending->request_.data_;
+    pending->iov_.iov_len = BUSTUB_PAGE_SIZE;
+
+    std::unique_lock<std::mutex> lock(latch_);
+    room_cv_.wait(lock, [this] { return in_flight_ < queue_depth_; });
+    in_flight_++;
+    io_uring_sqe *sqe = NextSqe();
+    // READV/WRITEV从5.1开始就有了，比READ/WRITE支持的内核多
+    sqe->opcode = pending->request_.is_write_ ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = disk_manager_->GetDbFd();
+    sqe->addr = reinterpret_cast<uint64_t>(&pending->iov_);
+    sqe->len = 1;
+    sqe->off = static_cast<uint64_t>(pending->request_.page_id_) * BUSTUB_PAGE_SIZE;
+    sqe->user_data = reinterpret_cast<uint64_t>(pending);
+    SubmitOne();
+  }
+
+ private:
+  struct Pending {
+    DiskRequest request_;
+    iovec iov_;
+    std::chrono::steady_clock::time_point submitted_at_;
+  };
+
+  IoUring(DiskManagerPosix *disk_manager, int ring_fd, size_t queue_depth)
+      : disk_manager_(disk_manager), ring_fd_(ring_fd), queue_depth_(queue_depth) {}
+
+  auto Map(const io_uring_params &params) -> bool {
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+      sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+    sq_ptr_ = MapRegion(sq_size_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == nullptr) {
+      return false;
+    }
+    cq_ptr_ = single_mmap ? sq_ptr_ : MapRegion(cq_size_, IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = static_cast<io_uring_sqe *>(MapRegion(sqes_size_, IORING_OFF_SQES));
+    if (cq_ptr_ == nullptr || sqes_ == nullptr) {
+      return false;
+    }
+
+    auto *sq = static_cast<char *>(sq_ptr_);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    auto *cq = static_cast<char *>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  auto MapRegion(size_t size, off_t offset) -> void * {
+    void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, offset);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+  }
+
+  /** The next free submission entry, cleared. Caller must hold latch_. */
+  auto NextSqe() -> io_uring_sqe * {
+    const unsigned index = *sq_tail_ & sq_mask_;
+    io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    return sqe;
+  }
+
+  /**
+   * Publish the entry returned by NextSqe() and hand it to the kernel. Caller must hold latch_. At most queue_depth_
+   * requests and the final NOP are in flight, and the kernel consumes the entries in io_uring_enter, so the submission
+   * queue never overflows.
+   */
+  void SubmitOne() {
+    __atomic_store_n(sq_tail_, *sq_tail_ + 1, __ATOMIC_RELEASE);
+    while (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0) {
+      BUSTUB_ASSERT(errno == EINTR || errno == EAGAIN || errno == EBUSY, "io_uring_enter failed");
+    }
+  }
+
+  void ReapLoop() {
+    bool stopping = false;
+    while (true) {
+      const unsigned head = *cq_head_;
+      if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        if (stopping) {
+          const std::lock_guard<std::mutex> guard(latch_);
+          if (in_flight_ == 0) {
+            return;
+          }
+        }
+        syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        continue;
+      }
+      const io_uring_cqe cqe = cqes_[head & cq_mask_];
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      if (cqe.user_data == 0) {
+        stopping = true;
+        continue;
+      }
+      Complete(reinterpret_cast<Pending *>(cqe.user_data), cqe.res);
+      {
+        const std::lock_guard<std::mutex> guard(latch_);
+        in_flight_--;
+      }
+      room_cv_.notify_one();
+    }
+  }
+
+  void Complete(Pending *pending, int res) {
+    auto &r = pending->request_;
+    if (res == BUSTUB_PAGE_SIZE) {
+      if (r.is_write_) {
+        disk_manager_->OnPageWritten(r.page_id_, std::chrono::steady_clock::now() - pending->submitted_at_);
+      }
+    } else if (!r.is_write_ && res >= 0) {
+      // 读到了文件末尾，和DiskManagerPosix::ReadPage()一样补0
+      memset(r.data_ + res, 0, BUSTUB_PAGE_SIZE - res);
+    } else {
+      // 出错或者只写了一部分(比如O_DIRECT下没有对齐的缓冲区)，交给disk manager同步地再做一遍
+      LOG_DEBUG("io_uring request of page %d returned %d, retrying it synchronously", r.page_id_, res);
+      if (r.is_write_) {
+        disk_manager_->WritePage(r.page_id_, r.data_);
+      } else {
+        disk_manager_->ReadPage(r.page_id_, r.data_);
+      }
+    }
+    r.callback_.set_value(true);
+    delete pending;
+  }
+
+  DiskManagerPosix *disk_manager_;
+  const int ring_fd_;
+  const size_t queue_depth_;
+
+  void *sq_ptr_{nullptr};
+  size_t sq_size_{0};
+  void *cq_ptr_{nullptr};
+  size_t cq_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe *cqes_{nullptr};
+
+  /** Protects the submission queue and in_flight_. */
+  std::mutex latch_;
+  std::condition_variable room_cv_;
+  size_t in_flight_{0};
+  std::thread reaper_;
+};
+
+#else
+
+class DiskScheduler::IoUring {
+ public:
+  static auto Create(DiskManagerPosix *disk_manager, size_t queue_depth) -> std::unique_ptr<IoUring> {
+    return nullptr;
+  }
+  void Submit(DiskRequest r) { UNREACHABLE("io_uring is not available"); }
+};
+
+#endif
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t queue_depth, bool use_io_uring)
+    : disk_manager_(disk_manager), queue_depth_(std::max<size_t>(queue_depth, 1)), use_io_uring_(use_io_uring) {}
+
+DiskScheduler::~DiskScheduler() {
+  // ring_的析构函数会等在途的请求完成；工作线程退出之前会把队列里的请求做完
+  ring_.reset();
+  {
+    const std::lock_guard<std::mutex> guard(latch_);
+    stop_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void DiskScheduler::Start() {
+  auto *posix_disk_manager = dynamic_cast<DiskManagerPosix *>(disk_manager_);
+  if (use_io_uring_ && posix_disk_manager != nullptr) {
+    ring_ = IoUring::Create(posix_disk_manager, queue_depth_);
+  }
+  if (ring_ == nullptr) {
+    const size_t num_workers = std::min<size_t>(queue_depth_, DISK_SCHEDULER_THREADS);
+    for (size_t i = 0; i < num_workers; i++) {
+      workers_.emplace_back(&DiskScheduler::WorkerLoop, this);
+    }
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest r) {
+  std::call_once(started_, &DiskScheduler::Start, this);
+  if (ring_ != nullptr) {
+    ring_->Submit(std::move(r));
+    return;
+  }
+  std::unique_lock<std::mutex> lock(latch_);
+  room_cv_.wait(lock, [this] { return queue_.size() < queue_depth_; });
+  queue_.push_back(std::move(r));
+  lock.unlock();
+  queue_cv_.notify_one();
+}
+
+auto DiskScheduler::ScheduleRead(page_id_t page_id, char *data) -> std::future<bool> {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  Schedule({/*is_write=*/false, data, page_id, std::move(promise)});
+  return future;
+}
+
+auto DiskScheduler::ScheduleWrite(page_id_t page_id, const char *data) -> std::future<bool> {
+  auto promise = CreatePromise();
+  auto future = promise.get_future();
+  // 写请求只读这块内存
+  Schedule({/*is_write=*/true, const_cast<char *>(data), page_id, std::move(promise)});
+  return future;
+}
+
+void DiskScheduler::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    queue_cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    auto r = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    room_cv_.notify_one();
+    Execute(&r);
+    lock.lock();
+  }
+}
+
+void DiskScheduler::Execute(DiskRequest *r) {
+  // 异常交给等待这个请求的线程，比如只读的disk manager不能写
+  try {
+    if (r->is_write_) {
+      disk_manager_->WritePage(r->page_id_, r->data_);
+    } else {
+      disk_manager_->ReadPage(r->page_id_, r->data_);
+    }
+  } catch (...) {
+    r->callback_.set_exception(std::current_exception());
+    return;
+  }
+  r->callback_.set_value(true);
+}
+
+}  // namespace bustub
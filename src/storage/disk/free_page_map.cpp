@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_page_map.cpp
+//
+// Identification: src/storage/disk/free_page_map.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_page_map.h"
+
+#include <array>
+#include <cstdlib>
+#include <utility>
+
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+FreePageMap::FreePageMap(DiskManager *disk_manager, page_id_t num_pages_on_disk, bool persistent)
+    : disk_manager_(disk_manager), num_pages_on_disk_(num_pages_on_disk), persistent_(persistent) {}
+
+void FreePageMap::Free(page_id_t page_id) {
+  BUSTUB_ASSERT(page_id >= 0 && !IsMapPage(page_id), "cannot free a map page");
+  std::scoped_lock lock(latch_);
+  Load();
+  const page_id_t group_no = page_id / PAGES_PER_GROUP;
+  const int bit = page_id % PAGES_PER_GROUP;
+  auto &group = groups_[group_no];
+  uint64_t &word = group.bits_[bit / 64];
+  const uint64_t mask = uint64_t{1} << (bit % 64);
+  if ((word & mask) != 0) {
+    return;
+  }
+  word |= mask;
+  group.num_free_++;
+  num_free_++;
+  MarkDirty(group_no);
+}
+
+auto FreePageMap::Allocate(page_id_t hint, uint32_t stride, uint32_t offset) -> page_id_t {
+  std::scoped_lock lock(latch_);
+  Load();
+  if (num_free_ == 0) {
+    return INVALID_PAGE_ID;
+  }
+  auto take = [this](std::map<page_id_t, Group>::iterator it, int bit) {
+    const page_id_t group_no = it->first;
+    auto &group = it->second;
+    group.bits_[bit / 64] &= ~(uint64_t{1} << (bit % 64));
+    group.num_free_--;
+    num_free_--;
+    MarkDirty(group_no);
+    // 组里没有空闲页了就不再放在内存里，它的位图全是0，和没有位图页是一样的
+    if (group.num_free_ == 0) {
+      groups_.erase(it);
+    }
+    return group_no * PAGES_PER_GROUP + bit;
+  };
+  // 先在hint所在的组里找离hint最近的页
+  auto hint_it = hint == INVALID_PAGE_ID ? groups_.end() : groups_.find(hint / PAGES_PER_GROUP);
+  if (hint_it != groups_.end()) {
+    const int bit = FindNear(hint_it->second, hint_it->first, hint % PAGES_PER_GROUP, stride, offset);
+    if (bit >= 0) {
+      return take(hint_it, bit);
+    }
+  }
+  // 再按页号从小到大找，让文件尽量紧凑
+  for (auto it = groups_.begin(); it != groups_.end(); ++it) {
+    if (it == hint_it) {
+      continue;
+    }
+    const int bit = FindNear(it->second, it->first, 0, stride, offset);
+    if (bit >= 0) {
+      return take(it, bit);
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+auto FreePageMap::GetNumFreePages() -> size_t {
+  std::scoped_lock lock(latch_);
+  Load();
+  return num_free_;
+}
+
+void FreePageMap::Load() {
+  if (loaded_) {
+    return;
+  }
+  loaded_ = true;
+  if (!persistent_) {
+    return;
+  }
+  for (page_id_t map_page_id = MAP_PAGE_OFFSET; map_page_id < num_pages_on_disk_;
+       map_page_id += PAGES_PER_GROUP) {
+    Group group;
+    disk_manager_->ReadPage(map_page_id, reinterpret_cast<char *>(group.bits_.get()));
+    for (size_t i = 0; i < WORDS_PER_GROUP; i++) {
+      group.num_free_ += __builtin_popcountll(group.bits_[i]);
+    }
+    if (group.num_free_ != 0) {
+      num_free_ += group.num_free_;
+      groups_.emplace(map_page_id / PAGES_PER_GROUP, std::move(group));
+    }
+  }
+}
+
+void FreePageMap::Flush() {
+  std::scoped_lock lock(latch_);
+  // 没有空闲页的组不在groups_里，写一个全0的位图页
+  const Group empty_group;
+  for (auto group_no : dirty_groups_) {
+    auto it = groups_.find(group_no);
+    const auto &group = it == groups_.end() ? empty_group : it->second;
+    disk_manager_->WritePage(group_no * PAGES_PER_GROUP + MAP_PAGE_OFFSET,
+                             reinterpret_cast<const char *>(group.bits_.get()));
+  }
+  dirty_groups_.clear();
+}
+
+void FreePageMap::MarkDirty(page_id_t group_no) {
+  if (persistent_) {
+    dirty_groups_.insert(group_no);
+  }
+}
+
+auto FreePageMap::FindNear(const Group &group, page_id_t group_no, int hint_bit, uint32_t stride, uint32_t offset)
+    -> int {
+  const auto base = static_cast<uint32_t>(group_no * PAGES_PER_GROUP);
+  const int hint_word = hint_bit / 64;
+  const int num_words = static_cast<int>(WORDS_PER_GROUP);
+  // 以hint所在的字为中心向两边一个字一个字地找，同一轮的两个字里取离hint最近的页
+  for (int distance = 0; hint_word - distance >= 0 || hint_word + distance < num_words; distance++) {
+    int best = -1;
+    const std::array<int, 2> words{hint_word - distance, hint_word + distance};
+    for (int i = 0; i < (distance == 0 ? 1 : 2); i++) {
+      const int w = words[i];
+      if (w < 0 || w >= num_words) {
+        continue;
+      }
+      uint64_t word = group.bits_[w];
+      while (word != 0) {
+        const int bit = w * 64 + __builtin_ctzll(word);
+        word &= word - 1;
+        if ((base + bit) % stride != offset) {
+          continue;
+        }
+        if (best < 0 || std::abs(bit - hint_bit) < std::abs(best - hint_bit)) {
+          best = bit;
+        }
+      }
+    }
+    if (best >= 0) {
+      return best;
+    }
+  }
+  return -1;
+}
+
+}  // namespace bustub
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <sstream>
 #include <string>
 
@@ -51,18 +52,34 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool {  // 以读的方式获取到根
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *txn) -> bool {
-  // Declaration of context instance.
-  Context ctx;  // 这个是上下文，用于记录访问的页面
-  (void)ctx;    // 对未使用变量抑制警告
-                // 先获取叶子节点的id
-  page_id_t leaf_page_id = GetKeyAt(key, comparator_, ctx);
-  if (leaf_page_id == INVALID_PAGE_ID) {
+  // 先不加锁乐观地查找，读完之后页面的版本号没变就说明读到的是一致的数据
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; attempt++) {
+    OptimisticReadGuard leaf_page_guard;
+    page_id_t leaf_page_id;
+    if (!OptimisticGetLeaf(key, &leaf_page_guard, &leaf_page_id)) {
+      continue;
+    }
+    if (leaf_page_id == INVALID_PAGE_ID) {
+      return false;
+    }
+    ValueType value;
+    bool is_success = leaf_page_guard.template As<LeafPage>()->FindValue(key, comparator_, &value);
+    if (!leaf_page_guard.Validate()) {
+      continue;
+    }
+    if (is_success) {
+      BUSTUB_ASSERT(result != nullptr, "result not nullptr");
+      result->push_back(value);
+    }
+    return is_success;
+  }
+
+  // 和写者冲突太多次了，退回到加读锁的查找
+  ReadPageGuard leaf_page_guard;
+  if (!FindLeafRead(&key, &leaf_page_guard)) {
     return false;
   }
   // 这里只要有根节点，就能够确定他在哪个叶子节点里面，叶子节点没有再返回false
-  // 先获取叶子节点的守卫
-  auto leaf_page_guard = std::move(ctx.read_set_.back());
-  ctx.read_set_.pop_back();
   auto *leaf_page = leaf_page_guard.As<LeafPage>();
   // 在叶子节点中查找
   int i = leaf_page->Lookup(key, comparator_);
@@ -76,47 +93,82 @@ auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return is_success;
 }
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::GetKeyAt(const KeyType &key, const KeyComparator &comparator, Context &ctx) -> page_id_t {
-  // 这个函数的功能就是找到key对应的叶子页号
-  // 先找到head_page读取其中的root_page_id
-  // 读取存储head_page的页
-  ReadPageGuard header_page_gurad = bpm_->FetchPageRead(header_page_id_);
-  // 现在就转换成了这个head指针指向对应的页数据，原来char类型指针指向数据，每次只能读取一个字符的数据，不是这个指针读不出来这个数据
-  auto *p_header_page = header_page_gurad.As<BPlusTreeHeaderPage>();
-  page_id_t root_page_id = p_header_page->root_page_id_;
-  if (root_page_id == INVALID_PAGE_ID) {
-    return INVALID_PAGE_ID;
+auto BPLUSTREE_TYPE::FindLeafRead(const KeyType *key, ReadPageGuard *leaf_guard) -> bool {
+  while (true) {
+    ReadPageGuard header_page_guard = bpm_->FetchPageRead(header_page_id_);
+    page_id_t page_id = header_page_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+    if (page_id == INVALID_PAGE_ID) {
+      return false;
+    }
+    // 先pin住下一个页面再放掉当前页面的锁：pin住的页面删不掉，页号也就不会被重用；同一时刻只拿着一个页面的读锁
+    BasicPageGuard next_page_guard = bpm_->FetchPageBasic(page_id);
+    header_page_guard.Drop();
+    ReadPageGuard page_guard = next_page_guard.UpgradeRead();
+    while (true) {
+      const auto *page = page_guard.As<BPlusTreePage>();
+      if (page->IsDeleted()) {
+        break;
+      }
+      int position = 0;
+      if (page->IsLeafPage()) {
+        const auto *leaf_page = page_guard.As<LeafPage>();
+        position = key == nullptr ? 0 : leaf_page->CompareToFences(*key, comparator_);
+        if (position == 0) {
+          *leaf_guard = std::move(page_guard);
+          return true;
+        }
+        page_id = leaf_page->GetNextPageId();
+      } else {
+        const auto *internal_page = page_guard.As<InternalPage>();
+        position = key == nullptr ? 0 : internal_page->CompareToFences(*key, comparator_);
+        if (position > 0) {
+          page_id = internal_page->GetNextPageId();
+        } else if (key == nullptr) {
+          page_id = internal_page->ValueAt(0);
+        } else {
+          internal_page->FindChild(*key, comparator_, &page_id);
+        }
+      }
+      // key被合并或者重分配挪到了左边的页面，右链走不回去，只能从根重来
+      if (position < 0) {
+        break;
+      }
+      // key被并发的分裂挪到了右边，沿右链往右走；否则往下走
+      next_page_guard = bpm_->FetchPageBasic(page_id);
+      page_guard.Drop();
+      page_guard = next_page_guard.UpgradeRead();
+    }
   }
-  // 找到了root_id，用上下文类来记录读取信息
-  ctx.root_page_id_ = root_page_id;
-  ctx.read_set_.push_back(std::move(header_page_gurad));
+}
 
-  // 开始读取根页面
-  ReadPageGuard root_page_guard = bpm_->FetchPageRead(root_page_id);
-  auto *root_page = root_page_guard.As<InternalPage>();
-  // 转化成对应的页面指针，每次读取的数据大小来能使用
-  ctx.access_set_.push_back(root_page_id);
-  ctx.read_set_.push_back(std::move(root_page_guard));
-  while (!root_page->IsLeafPage()) {
-    // 如果不是叶子页面
-    // 在内部页面上二分查找
-    int i = root_page->Lookup(key, comparator);  // 其实找到的是第一个大于等于的位置
-    if (i != root_page->GetSize() && comparator(key, root_page->KeyAt(i)) == 0) {
-      // 这个就是要叶子页的page_id
-      root_page_id = root_page->ValueAt(i);
-    } else {
-      // 其他情况的话，因为如果等于就是id，大于就是下一个id
-      root_page_id = root_page->ValueAt(i - 1);
-      // 不理解就去读Lookup
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::OptimisticGetLeaf(const KeyType &key, OptimisticReadGuard *leaf_guard, page_id_t *leaf_page_id)
+    -> bool {
+  OptimisticReadGuard parent_guard = bpm_->FetchPageOptimistic(header_page_id_);
+  page_id_t page_id = parent_guard.template As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (!parent_guard.Validate()) {
+    return false;
+  }
+  *leaf_page_id = INVALID_PAGE_ID;
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+  while (true) {
+    OptimisticReadGuard page_guard = bpm_->FetchPageOptimistic(page_id);
+    // 拿到子页面之后父页面还没被改过，说明这个子页面确实是父页面指向的页面
+    if (!parent_guard.Validate()) {
+      return false;
     }
-    // 读取下一个页面
-    root_page_guard = bpm_->FetchPageRead(root_page_id);
-    root_page = root_page_guard.As<InternalPage>();
-    ctx.read_set_.pop_back();
-    ctx.read_set_.push_back(std::move(root_page_guard));
-    ctx.access_set_.push_back(root_page_id);
+    if (page_guard.template As<BPlusTreePage>()->IsLeafPage()) {
+      *leaf_guard = std::move(page_guard);
+      *leaf_page_id = page_id;
+      return true;
+    }
+    if (!page_guard.template As<InternalPage>()->FindChild(key, comparator_, &page_id) || !page_guard.Validate()) {
+      return false;
+    }
+    parent_guard = std::move(page_guard);
   }
-  return root_page_id;
 }
 
 /*****************************************************************************
@@ -139,10 +191,7 @@ auto BPLUSTREE_TYPE::InsertGetKeyAt(const KeyType &key, const KeyComparator &com
     bpm_->NewPageGuarded(&root_page_id);
     auto write_guard = bpm_->FetchPageWrite(root_page_id);
     auto *p_leaf_page = write_guard.AsMut<BPlusTree::LeafPage>();
-    p_leaf_page->SetPageType(IndexPageType::LEAF_PAGE);
-    p_leaf_page->SetMaxSize(leaf_max_size_);
-    p_leaf_page->SetNextPageId(INVALID_PAGE_ID);
-    p_leaf_page->SetSize(0);
+    p_leaf_page->Init(leaf_max_size_);
     SetRootPageId(root_page_id, ctx);
     ctx.write_set_.push_back(std::move(write_guard));
     ctx.access_set_.push_back(root_page_id);
@@ -152,6 +201,10 @@ auto BPLUSTREE_TYPE::InsertGetKeyAt(const KeyType &key, const KeyComparator &com
   ctx.root_page_id_ = root_page_id;
   WritePageGuard root_page_guard = bpm_->FetchPageWrite(root_page_id);
   auto *root_page = root_page_guard.AsMut<BPlusTree::InternalPage>();
+  // 根页面不会分裂的话，根页面号就不会变，头页面可以先放掉
+  if (root_page->GetSize() + 1 < root_page->GetMaxSize()) {
+    ctx.header_page_.reset();
+  }
   ctx.access_set_.push_back(root_page_id);
   ctx.write_set_.push_back(std::move(root_page_guard));
   while (!root_page->IsLeafPage()) {
@@ -188,8 +241,50 @@ void BPLUSTREE_TYPE::SetRootPageId(page_id_t page_id, Context &ctx) {
   // BPlusTreeHeaderPage指针
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::GetLeafForWrite(const KeyType &key, WritePageGuard *leaf_guard, bool *is_root) -> bool {
+  ReadPageGuard parent_page_guard = bpm_->FetchPageRead(header_page_id_);
+  page_id_t page_id = parent_page_guard.As<BPlusTreeHeaderPage>()->root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  *is_root = true;
+  while (true) {
+    ReadPageGuard page_guard = bpm_->FetchPageRead(page_id);
+    auto *page = page_guard.As<BPlusTree::InternalPage>();
+    if (page->IsLeafPage()) {
+      // 父页面还加着读锁，要分裂或者合并这个叶子的写者进不来，放掉读锁再加写锁也还是这个叶子
+      if (!page_guard.TryUpgrade(leaf_guard)) {
+        page_guard.Drop();
+        *leaf_guard = bpm_->FetchPageWrite(page_id);
+      }
+      return true;
+    }
+    page->FindChild(key, comparator_, &page_id);
+    parent_page_guard = std::move(page_guard);
+    *is_root = false;
+  }
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *txn) -> bool {
+  // 先乐观地只给叶子加写锁，叶子不用分裂就直接插入，否则从头加写锁再来一遍
+  {
+    WritePageGuard leaf_page_guard;
+    bool is_root;
+    if (GetLeafForWrite(key, &leaf_page_guard, &is_root)) {
+      const auto *leaf_page = leaf_page_guard.As<LeafPage>();
+      int index = leaf_page->Lookup(key, comparator_);
+      if (index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
+        return false;
+      }
+      if (leaf_page->GetSize() + 1 < leaf_page->GetMaxSize()) {
+        leaf_page_guard.AsMut<LeafPage>()->Insert(key, value, comparator_);
+        return true;
+      }
+    }
+  }
+
   // Declaration of context instance.
   Context ctx;
   (void)ctx;  // Suppresses unused variable warning.
@@ -206,7 +301,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   int index = leaf_page->Lookup(key, comparator_);
 
   // If the key already exists in the tree, return false.
-  if (index > 0 && index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
+  if (index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), key) == 0) {
     // 已经存在
     is_success = false;
   } else {
@@ -216,16 +311,12 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     } else {
       // If there is not enough space in the leaf page, create a new leaf page and redistribute the keys.
       page_id_t leaf_page_id_new;
-      bpm_->NewPageGuarded(&leaf_page_id_new);
+      bpm_->NewPageGuarded(&leaf_page_id_new, leaf_page_id);  // 新的叶子页尽量放在被分裂的页旁边
       auto leaf_page_new_guard = bpm_->FetchPageWrite(leaf_page_id_new);
       auto *leaf_page_new = leaf_page_new_guard.template AsMut<B_PLUS_TREE_LEAF_PAGE_TYPE>();
-      leaf_page_new->SetMaxSize(leaf_max_size_);
-      leaf_page_new->SetSize(0);
-      leaf_page_new->SetPageType(IndexPageType::LEAF_PAGE);
-      leaf_page_new->SetNextPageId(leaf_page->GetNextPageId());
+      leaf_page_new->Init(leaf_max_size_);
       leaf_page->MoveHalfTo(leaf_page_new);
       // Determine whether to insert the new (key, value) pair in the old leaf page or the new leaf page.
-      leaf_page->SetNextPageId(leaf_page_id_new);
       if (index <= (leaf_page->GetMaxSize() - 1) / 2) {
         leaf_page->Insert(key, value, comparator_);
       } else {
@@ -234,12 +325,124 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
       }
       // Get the key at the first position of the new leaf page and insert it into the parent node.
       KeyType mid_key = leaf_page_new->KeyAt(0);
+      // 先接上右链，还没等到父页面更新的读者也能往右找到搬走的key
+      leaf_page->LinkRightSibling(leaf_page_new, leaf_page_id_new, mid_key);
       InsertInParent(leaf_page_id, mid_key, leaf_page_id_new, ctx);
     }
     is_success = true;
   }
   return is_success;
 }
+/*
+ * Build the tree from scratch: sort, pack leaves, then pack internal levels
+ * until one page is left. The header page stays write latched throughout, so
+ * no other operation sees a half built tree.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(std::vector<std::pair<KeyType, ValueType>> entries, double fill_factor) -> bool {
+  BUSTUB_ASSERT(fill_factor > 0 && fill_factor <= 1, "fill factor must be in (0, 1]");
+  WritePageGuard header_page_guard = bpm_->FetchPageWrite(header_page_id_);
+  auto *header_page = header_page_guard.AsMut<BPlusTreeHeaderPage>();
+  if (header_page->root_page_id_ != INVALID_PAGE_ID) {
+    return false;
+  }
+  if (entries.empty()) {
+    return true;
+  }
+
+  // 稳定排序，重复的key保留先出现的那个，和一条条插入的结果一样
+  std::stable_sort(entries.begin(), entries.end(),
+                   [this](const auto &lhs, const auto &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+  auto last = std::unique(entries.begin(), entries.end(),
+                          [this](const auto &lhs, const auto &rhs) { return comparator_(lhs.first, rhs.first) == 0; });
+  entries.erase(last, entries.end());
+
+  // 叶子最多放leaf_max_size_-1个，放满max_size就要分裂了
+  const int leaf_capacity = leaf_max_size_ - 1;
+  const int leaf_min_size = leaf_max_size_ / 2;
+  const int leaf_target = std::clamp(static_cast<int>(leaf_capacity * fill_factor), std::max(leaf_min_size, 1),
+                                     std::max(leaf_capacity, 1));
+
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  WritePageGuard prev_leaf_guard;
+  page_id_t prev_leaf_id = INVALID_PAGE_ID;
+  size_t next = 0;
+  for (int size : BulkLoadPageSizes(entries.size(), leaf_target, leaf_min_size, std::max(leaf_capacity, 1))) {
+    page_id_t leaf_page_id;
+    bpm_->NewPageGuarded(&leaf_page_id, prev_leaf_id);  // 相邻的叶子尽量放在相邻的页上，扫描的时候是顺序读
+    auto leaf_page_guard = bpm_->FetchPageWrite(leaf_page_id);
+    auto *leaf_page = leaf_page_guard.AsMut<LeafPage>();
+    leaf_page->Init(leaf_max_size_);
+    leaf_page->SetNextPageId(INVALID_PAGE_ID);
+    for (int i = 0; i < size; i++, next++) {
+      leaf_page->Append(entries[next].first, entries[next].second);
+    }
+    if (prev_leaf_id != INVALID_PAGE_ID) {
+      prev_leaf_guard.AsMut<LeafPage>()->LinkRightSibling(leaf_page, leaf_page_id, leaf_page->KeyAt(0));
+    }
+    level.emplace_back(leaf_page->KeyAt(0), leaf_page_id);
+    prev_leaf_guard = std::move(leaf_page_guard);
+    prev_leaf_id = leaf_page_id;
+  }
+  prev_leaf_guard.Drop();
+
+  while (level.size() > 1) {
+    level = BulkLoadInternalLevel(level, fill_factor);
+  }
+  header_page->root_page_id_ = level[0].second;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadInternalLevel(const std::vector<std::pair<KeyType, page_id_t>> &children,
+                                           double fill_factor) -> std::vector<std::pair<KeyType, page_id_t>> {
+  // 内部页面最多有internal_max_size_个孩子，根至少要有两个孩子
+  const int internal_min_size = std::max((internal_max_size_ + 1) / 2, 2);
+  const int internal_target = std::clamp(static_cast<int>(internal_max_size_ * fill_factor), internal_min_size,
+                                         std::max(internal_max_size_, internal_min_size));
+
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  WritePageGuard prev_page_guard;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  size_t next = 0;
+  for (int size : BulkLoadPageSizes(children.size(), internal_target, internal_min_size, internal_max_size_)) {
+    page_id_t internal_page_id;
+    bpm_->NewPageGuarded(&internal_page_id, prev_page_id);
+    auto internal_page_guard = bpm_->FetchPageWrite(internal_page_id);
+    auto *internal_page = internal_page_guard.AsMut<InternalPage>();
+    internal_page->Init(internal_max_size_);
+    // 第0个孩子没有key，它的key交给上一层
+    level.emplace_back(children[next].first, internal_page_id);
+    if (prev_page_id != INVALID_PAGE_ID) {
+      prev_page_guard.AsMut<InternalPage>()->LinkRightSibling(internal_page, internal_page_id, children[next].first);
+    }
+    internal_page->InsertFirstOf(children[next++].second);
+    for (int i = 1; i < size; i++, next++) {
+      internal_page->Append(children[next].first, children[next].second);
+    }
+    prev_page_guard = std::move(internal_page_guard);
+    prev_page_id = internal_page_id;
+  }
+  return level;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoadPageSizes(size_t n, int target, int min_size, int max_size) -> std::vector<int> {
+  auto num_pages = (n + target - 1) / target;
+  // 最后一页不够min_size的话少分一页，多出来的平摊到前面；页数不能少于ceil(n / max_size)，否则会超过上限
+  const size_t min_num_pages = (n + max_size - 1) / max_size;
+  while (num_pages > std::max<size_t>(min_num_pages, 1) && n < num_pages * min_size) {
+    num_pages--;
+  }
+  std::vector<int> sizes(num_pages, static_cast<int>(n / num_pages));
+  for (size_t i = 0; i < n % num_pages; i++) {
+    sizes[i]++;
+  }
+  // 多出来的都分给了前面的页，第一页最大
+  BUSTUB_ASSERT(sizes[0] <= max_size, "bulk loaded page is over its max size");
+  return sizes;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertInParent(page_id_t leaf_page_left_id, KeyType key, page_id_t leaf_page_right_id,
                                     Context &ctx) {
@@ -250,16 +453,14 @@ void BPLUSTREE_TYPE::InsertInParent(page_id_t leaf_page_left_id, KeyType key, pa
   if (root_page_id == leaf_page_left_id) {
     // leafPage is root page
     page_id_t root_page_new_id;
-    bpm_->NewPageGuarded(&root_page_new_id);
+    bpm_->NewPageGuarded(&root_page_new_id, leaf_page_left_id);
 
     // Find the leaf page where the key-value pair should be inserted.
     auto root_page_new_guard = bpm_->FetchPageWrite(root_page_new_id);
     //    auto root_page_new_guard = ctx.GetWritePageGuardAt(bpm_,root_page_new_id);
     auto *root_page_new =
         root_page_new_guard.template AsMut<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator>>();
-    root_page_new->SetPageType(IndexPageType::INTERNAL_PAGE);
-    root_page_new->SetMaxSize(internal_max_size_);
-    root_page_new->SetSize(0);
+    root_page_new->Init(internal_max_size_);
     root_page_new->InsertFirstOf(leaf_page_left_id);
     root_page_new->Insert(key, leaf_page_right_id, comparator_);
     SetRootPageId(root_page_new_id, ctx);
@@ -276,13 +477,11 @@ void BPLUSTREE_TYPE::InsertInParent(page_id_t leaf_page_left_id, KeyType key, pa
       // 内部节点split
       int index = parent_page->Lookup(key, comparator_);
       page_id_t parent_page_new_id;
-      bpm_->NewPageGuarded(&parent_page_new_id);
+      bpm_->NewPageGuarded(&parent_page_new_id, parent_page_id);
       auto parent_page_new_guard = bpm_->FetchPageWrite(parent_page_new_id);
       //      auto parent_page_new_guard = ctx.GetWritePageGuardAt(bpm_,parent_page_new_id);
       auto *parent_page_new = parent_page_new_guard.template AsMut<BPlusTree::InternalPage>();
-      parent_page_new->SetPageType(IndexPageType::INTERNAL_PAGE);
-      parent_page_new->SetMaxSize(internal_max_size_);
-      parent_page_new->SetSize(0);
+      parent_page_new->Init(internal_max_size_);
       parent_page->MoveHalfTo(parent_page_new);
       // index >= ceil((n+1)/2)
       if (index >= ((parent_page->GetMaxSize() + 1) + 1) / 2) {
@@ -296,6 +495,7 @@ void BPLUSTREE_TYPE::InsertInParent(page_id_t leaf_page_left_id, KeyType key, pa
       parent_page_new->EraseAt(1);
       parent_page_new->EraseAt(0);
       parent_page_new->InsertFirstOf(mid_page_id);
+      parent_page->LinkRightSibling(parent_page_new, parent_page_new_id, mid_key);
       InsertInParent(parent_page_id, mid_key, parent_page_new_id, ctx);
     }
   }
@@ -321,6 +521,24 @@ auto BPLUSTREE_TYPE::GetParentPageId(page_id_t child, Context &ctx) -> page_id_t
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *txn) {
+  // 和插入一样，叶子删完不会少于半满就只给叶子加写锁
+  {
+    WritePageGuard leaf_page_guard;
+    bool is_root;
+    if (!GetLeafForWrite(key, &leaf_page_guard, &is_root)) {
+      return;
+    }
+    const auto *leaf_page = leaf_page_guard.As<LeafPage>();
+    int index = leaf_page->Lookup(key, comparator_);
+    if (index == leaf_page->GetSize() || comparator_(leaf_page->KeyAt(index), key) != 0) {
+      return;
+    }
+    if (is_root ? leaf_page->GetSize() > 1 : leaf_page->GetSize() - 1 >= leaf_page->GetMinSize()) {
+      leaf_page_guard.AsMut<LeafPage>()->RemoveAt(index);
+      return;
+    }
+  }
+
   // Declaration of context instance.
   Context ctx;
   (void)ctx;
@@ -345,6 +563,10 @@ auto BPLUSTREE_TYPE::DeleteGetKeyAt(const KeyType &key, const KeyComparator &com
   }
   WritePageGuard root_page_guard = bpm_->FetchPageWrite(root_page_id);
   auto *root_page = root_page_guard.AsMut<BPlusTree::InternalPage>();
+  // 根是叶子时删空了才换根，是内部页面时只剩一个孩子才换根
+  if (root_page->GetSize() > (root_page->IsLeafPage() ? 1 : 2)) {
+    ctx.header_page_.reset();
+  }
   ctx.access_set_.push_back(root_page_id);
   ctx.write_set_.push_back(std::move(root_page_guard));
   while (!root_page->IsLeafPage()) {
@@ -390,12 +612,17 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
   }
   int root_page_id = ctx.root_page_id_;
   if (basic_page_id == root_page_id && basic_page->GetSize() == 0) {
-    SetTreeEmpty(ctx);               // 根页面删空了
+    SetTreeEmpty(ctx);  // 根页面删空了
+    // 读者可能已经pin住了这个页面，标成删掉的让它从根重来
+    basic_page->SetPageType(IndexPageType::INVALID_INDEX_PAGE);
+    basic_page_guard.Drop();         // 还pin着的页面删不掉
     bpm_->DeletePage(root_page_id);  // 就把这片存储空间删除
   } else if (basic_page_id == root_page_id && basic_page->GetSize() == 1 && !basic_page->IsLeafPage()) {
     // 删除的页面是跟页面且删除之后就剩一个元素，并且不是叶子页面是内部页面
     auto *root_page = basic_page_guard.AsMut<BPlusTree::InternalPage>();
     SetRootPageId(root_page->ValueAt(0), ctx);
+    root_page->SetPageType(IndexPageType::INVALID_INDEX_PAGE);
+    basic_page_guard.Drop();
     bpm_->DeletePage(root_page_id);
   } else if (basic_page_id != root_page_id && basic_page->GetSize() < basic_page->GetMinSize()) {
     // 这是删除之后出现半满的情况，需要合并或者重分配操作
@@ -437,6 +664,8 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
         sibling_internal_page->Insert(mid_key, mid_key_page_id, comparator_);
         // 再把全部的移动过去,注意是从1开始移动的，因为0号数据没有删除
         basic_internal_page->MoveAllTo(sibling_internal_page);
+        sibling_internal_page->SetHighKey(basic_internal_page->GetHighKey());
+        sibling_internal_page->SetNextPageId(basic_internal_page->GetNextPageId());
       } else {
         // 叶子页面
         // 与leafpage sibling节点合并，直接move即可
@@ -444,12 +673,16 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
         auto *sibling_leaf_page = sibling_page_guard.AsMut<BPlusTree::LeafPage>();
         basic_leaf_page->MoveAllTo(sibling_leaf_page);
         // 叶子节点的前后是需要建立连接的
+        sibling_leaf_page->SetHighKey(basic_leaf_page->GetHighKey());
         sibling_leaf_page->SetNextPageId(basic_leaf_page->GetNextPageId());
       }
+      // 右链已经绕过了basic，还pin着它的读者看到删除标记就从根重来
+      basic_page->SetPageType(IndexPageType::INVALID_INDEX_PAGE);
       // 下面就是删除空出来的basic页面
       ctx.write_set_.push_back(std::move(parent_page_guard));  // 对父页面进行解锁
       RemoveEntry(parent_page_id, mid_key, ctx);               // 删除父页面对basic页面的指向
-      bpm_->DeletePage(basic_page_id);                         // 删除空闲页面，空出空间
+      basic_page_guard.Drop();
+      bpm_->DeletePage(basic_page_id);  // 删除空闲页面，空出空间
     } else {
       // 合并不了就要重分配，因为删除一个没有半满，那么就从兄弟页面拿一个过来
       int index = parent_page->Lookup(key, comparator_);
@@ -472,6 +705,8 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
           // 将自己的第一个指针作为basic的第一个page_id，即arraty_[1].Value
           // 父页面的key要换掉
           ReplaceKeyAt(parent_page, mid_key, first_key, ctx);
+          basic_internal_page->SetHighKey(first_key);
+          sibling_internal_page->SetLowKey(first_key);
         } else {
           // 叶子节点的话，就把sibling的第一个移动到basic上去就行
           auto *basic_leaf_page = basic_page_guard.AsMut<BPlusTree::LeafPage>();
@@ -479,6 +714,8 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
           sibling_leaf_page->MoveFirstToEndOf(basic_leaf_page);
           KeyType second_key = sibling_leaf_page->KeyAt(0);
           ReplaceKeyAt(parent_page, mid_key, second_key, ctx);
+          basic_leaf_page->SetHighKey(second_key);
+          sibling_leaf_page->SetLowKey(second_key);
         }
       } else {
         // 这时候sibling就在basic前面，sibling最后移动一个到basic前面
@@ -498,6 +735,8 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
           // 以插入的方式插入原来的0号数据
           basic_internal_page->Insert(mid_key, basic_pointer_page_id, comparator_);
           ReplaceKeyAt(parent_page, mid_key, last_key, ctx);
+          sibling_internal_page->SetHighKey(last_key);
+          basic_internal_page->SetLowKey(last_key);
         } else {
           // 叶子节点就直接把他左边最后移动过去
           auto *basic_leaf_page = basic_page_guard.AsMut<BPlusTree::LeafPage>();
@@ -508,6 +747,8 @@ void BPLUSTREE_TYPE::RemoveEntry(page_id_t basic_page_id, const KeyType &key, Co
           sibling_leaf_page->RemoveAt(m);
           basic_leaf_page->Insert(last_key, last_value, comparator_);
           ReplaceKeyAt(parent_page, mid_key, last_key, ctx);
+          sibling_leaf_page->SetHighKey(last_key);
+          basic_leaf_page->SetLowKey(last_key);
         }
       }
     }
@@ -575,23 +816,11 @@ void BPLUSTREE_TYPE::ReplaceKeyAt(BPlusTree::InternalPage *page, const KeyType &
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  // Context ctx;
-  auto root_page_id = GetRootPageId();
-  //  ReadPageGuard root_page_guard = ctx.GetReadPageGuardAt(bpm_,root_page_id);
-  if (root_page_id == INVALID_PAGE_ID) {
+  ReadPageGuard leaf_page_guard;
+  if (!FindLeafRead(nullptr, &leaf_page_guard)) {
     return INDEXITERATOR_TYPE();
   }
-  BasicPageGuard root_page_guard = bpm_->FetchPageBasic(root_page_id);
-  auto *root_page = root_page_guard.As<BPlusTree::InternalPage>();
-  while (!root_page->IsLeafPage()) {
-    root_page_id = root_page->ValueAt(0);
-    if (root_page_id != INVALID_PAGE_ID) {
-      root_page_guard = bpm_->FetchPageBasic(root_page_id);
-      root_page = root_page_guard.As<BPlusTree::InternalPage>();
-    }
-  }
-  auto *leaf_page = root_page_guard.As<BPlusTree::LeafPage>();
-  return INDEXITERATOR_TYPE(bpm_, leaf_page, 0, std::move(root_page_guard));
+  return INDEXITERATOR_TYPE(this, bpm_, &comparator_, std::move(leaf_page_guard), 0);
 }
 
 /*
@@ -601,22 +830,17 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  Context ctx;
-  (void)ctx;
   // 找到所在的页面
-  auto page_id = GetKeyAt(key, comparator_, ctx);
-  ctx.read_set_.clear();
-  if (page_id == INVALID_PAGE_ID) {
+  ReadPageGuard leaf_page_guard;
+  if (!FindLeafRead(&key, &leaf_page_guard)) {
     return INDEXITERATOR_TYPE();
   }
-  BasicPageGuard leaf_page_guard = bpm_->FetchPageBasic(page_id);
-  ctx.read_set_.pop_back();
   const auto *leaf_page = leaf_page_guard.As<BPlusTree::LeafPage>();
   int index = leaf_page->Lookup(key, comparator_);
-  if (comparator_(leaf_page->KeyAt(index), key) != 0) {
+  if (index == leaf_page->GetSize() || comparator_(leaf_page->KeyAt(index), key) != 0) {
     return INDEXITERATOR_TYPE();
   }
-  return INDEXITERATOR_TYPE(bpm_, leaf_page, index, std::move(leaf_page_guard));
+  return INDEXITERATOR_TYPE(this, bpm_, &comparator_, std::move(leaf_page_guard), index);
 }
 
 /*
@@ -625,7 +849,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(nullptr, nullptr, -1, BasicPageGuard()); }
+auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
 
 /**
  * @return Page id of the root of this tree
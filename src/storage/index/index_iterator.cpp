@@ -1,8 +1,10 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -15,49 +17,110 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator() = default;
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager *bpm, const B_PLUS_TREE_LEAF_PAGE_TYPE *page, int index,
-                                  BasicPageGuard page_guard) {
-  bpm_ = bpm;
-  page_ = page;
-  index_ = index;
-  page_guard_ = std::move(page_guard);
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, BufferPoolManager *bpm,
+                                  const KeyComparator *comparator, ReadPageGuard leaf_guard, int index)
+    : tree_(tree), bpm_(bpm), comparator_(comparator) {
+  Seek(std::move(leaf_guard), index);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::IsEnd() -> bool {
-  bool is_end = false;
-  if ((page_ == nullptr) && (bpm_ == nullptr) && index_ == -1) {
-    is_end = true;
-  }
-  return is_end;
-}
+auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_id_ == INVALID_PAGE_ID; }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return page_->GetObjAt(index_); }
+auto INDEXITERATOR_TYPE::operator*() -> const MappingType & { return item_; }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-  // 等于号是因为叶子页面装不满
-  if (index_ + 1 >= page_->GetSize()) {
-    page_id_t next_page_id = page_->GetNextPageId();
-    if (next_page_id != INVALID_PAGE_ID) {
-      page_guard_ = bpm_->FetchPageBasic(next_page_id);
-      page_ = page_guard_.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
-      index_ = 0;
-    } else {
-      page_ = nullptr;
-      index_ = -1;
-      bpm_ = nullptr;
+  // pin一直没放，页面不会被删掉重用，这里只是重新加上读锁
+  ReadPageGuard leaf_guard = page_guard_.UpgradeRead();
+  const auto *leaf_page = leaf_guard.template As<LeafPage>();
+  // 叶子被合并掉了，或者当前key后面的条目被重分配挪到了左边的叶子，从根重新找当前key所在的叶子
+  if (leaf_page->IsDeleted() || leaf_page->CompareToFences(item_.first, *comparator_) < 0) {
+    leaf_guard.Drop();
+    if (!tree_->FindLeafRead(&item_.first, &leaf_guard)) {
+      *this = IndexIterator();
+      return *this;
     }
-  } else {
-    index_++;
+    leaf_page = leaf_guard.template As<LeafPage>();
   }
+  // 读的时候可能有插入和删除，当前条目的位置变了，按key找它后面的第一个
+  int index = IndexAfterItem(leaf_page);
+  Seek(std::move(leaf_guard), index);
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::IndexAfterItem(const LeafPage *leaf_page) const -> int {
+  int index = leaf_page->Lookup(item_.first, *comparator_);
+  if (index < leaf_page->GetSize() && (*comparator_)(leaf_page->KeyAt(index), item_.first) == 0) {
+    index++;
+  }
+  return index;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Seek(ReadPageGuard leaf_guard, int index) {
+  while (true) {
+    const auto *leaf_page = leaf_guard.template As<LeafPage>();
+    if (index < leaf_page->GetSize()) {
+      item_ = leaf_page->GetObjAt(index);
+      index_ = index;
+      if (leaf_guard.PageId() != page_id_) {
+        page_id_ = leaf_guard.PageId();
+        ReadAhead(leaf_page->GetNextPageId());
+      }
+      page_guard_ = leaf_guard.Downgrade();
+      return;
+    }
+    page_id_t next_page_id = leaf_page->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      leaf_guard.Drop();
+      *this = IndexIterator();
+      return;
+    }
+    // 这个叶子里已经没有更大的key了，右兄弟从high_key开始
+    KeyType high_key = leaf_page->GetHighKey();
+    BasicPageGuard next_page_guard = bpm_->FetchPageBasic(next_page_id, AccessType::Scan);
+    leaf_guard.Drop();
+    leaf_guard = next_page_guard.UpgradeRead();
+    leaf_page = leaf_guard.template As<LeafPage>();
+    // 右兄弟被合并掉了，或者它的low key变大了，说明high_key后面的条目被挪到了左边，从根重新找
+    if (leaf_page->IsDeleted() || (*comparator_)(leaf_page->GetLowKey(), high_key) > 0) {
+      leaf_guard.Drop();
+      if (!tree_->FindLeafRead(&high_key, &leaf_guard)) {
+        *this = IndexIterator();
+        return;
+      }
+      leaf_page = leaf_guard.template As<LeafPage>();
+    }
+    index = leaf_page->Lookup(high_key, *comparator_);
+    // 当前条目自己也可能被分裂挪到了右边，要从它后面开始
+    if (page_id_ != INVALID_PAGE_ID) {
+      index = std::max(index, IndexAfterItem(leaf_page));
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadAhead(page_id_t next_page_id) {
+  const size_t read_ahead_pages = scan_read_ahead_pages.load();
+  if (read_ahead_pages == 0 || next_page_id == INVALID_PAGE_ID || bpm_ == nullptr) {
+    return;
+  }
+  // 每走过一半的窗口就再往后预读一个窗口
+  if (pages_until_read_ahead_ > 0) {
+    pages_until_read_ahead_--;
+    return;
+  }
+  pages_until_read_ahead_ = read_ahead_pages / 2;
+  bpm_->PrefetchPageChain(next_page_id, read_ahead_pages, [](const char *page_data) {
+    return reinterpret_cast<const B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_data)->GetNextPageId();
+  });
+}
+
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
 
 template class IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
@@ -21,14 +21,66 @@ namespace bustub {
  *****************************************************************************/
 /*
  * Init method after creating a new internal page
- * Including set page type, set current size, and set max page size
+ * Including set page type, set current size, and set max page size. The page has no right sibling and no fence
+ * keys, like a root page.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(int max_size) {
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetSize(0);
   SetMaxSize(max_size);
+  next_page_id_ = INVALID_PAGE_ID;
+  has_low_key_ = 0;
 }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+/*
+ * Helper methods of the B-link fence keys
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasLowKey() const -> bool { return has_low_key_ != 0; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetLowKey() const -> KeyType { return low_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetLowKey(const KeyType &key) {
+  low_key_ = key;
+  has_low_key_ = 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const -> KeyType { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &key) { high_key_ = key; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::CompareToFences(const KeyType &key, const KeyComparator &comparator) const -> int {
+  if (HasLowKey() && comparator(key, low_key_) < 0) {
+    return -1;
+  }
+  if (next_page_id_ != INVALID_PAGE_ID && comparator(key, high_key_) >= 0) {
+    return 1;
+  }
+  return 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::LinkRightSibling(BPlusTreeInternalPage *sibling, page_id_t sibling_page_id,
+                                                      const KeyType &separator) {
+  sibling->SetLowKey(separator);
+  sibling->SetHighKey(high_key_);
+  sibling->SetNextPageId(next_page_id_);
+  high_key_ = separator;
+  next_page_id_ = sibling_page_id;
+}
+
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
@@ -54,22 +106,30 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { ret
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> int {
-  // 内部节点第一个key是空，因为是key存的page_id是大于等于key的数据位置
-  // 所以这次查找可能找不到相等的key，只需要找到大于等于index的最小的key
-  // 基于这个算法，最终的即使找不到对应的，他也会找到大于等于index的最小的key
-  int l = 1;
-  int r = GetSize() - 1;
-  int ans = r + 1;  // 先把他放到最后一个
-  while (l <= r) {
-    int mid = (l + r) >> 1;
-    if (comparator(array_[mid].first, key) >= 0) {
-      ans = mid;
-      r = mid - 1;  // ans记录的是r的右边一位，说明ans是比key大的，当key足够大的时候就不会进入这部分，所以预设等于r+1
-    } else {
-      l = mid + 1;
-    }
+  return Lookup(key, comparator, GetSize());
+}
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindChild(const KeyType &key, const KeyComparator &comparator,
+                                                ValueType *child) const -> bool {
+  // 页面可能正在被修改，大小只读一次，并且检查它在页面的范围之内
+  int size = GetSize();
+  if (size < 1 || size > static_cast<int>(INTERNAL_PAGE_SIZE)) {
+    return false;
   }
-  return ans;  // 总的来说返回的是大于等于key的第一个索引位置
+  int i = Lookup(key, comparator, size);
+  if (i != size && comparator(key, array_[i].first) == 0) {
+    *child = array_[i].second;
+  } else {
+    *child = array_[i - 1].second;
+  }
+  return true;
+}
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator, int size) const
+    -> int {
+  // 内部节点第一个key是空，因为是key存的page_id是大于等于key的数据位置
+  // 所以这次查找可能找不到相等的key，只需要找到大于等于key的最小的key，从1开始找
+  return KeyLowerBound(array_, 1, size, key, comparator);
 }
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertFirstOf(const page_id_t &value) {
@@ -163,6 +223,12 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(B_PLUS_TREE_INTERNAL_PAGE_TYPE *r
   recipient->IncreaseSize(n - 1);
   this->IncreaseSize(-(n - 1));
 }
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Append(const KeyType &key, const page_id_t &value) {
+  array_[GetSize()] = std::make_pair(key, value);
+  IncreaseSize(1);
+}
+
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
 template class BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
@@ -23,13 +23,16 @@ namespace bustub {
 
 /**
  * Init method after creating a new leaf page
- * Including set page type, set current size to zero, set next page id and set max size
+ * Including set page type, set current size to zero, set next page id and set max size. The page has no fence keys,
+ * like a root page.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(int max_size) {
   SetPageType(IndexPageType::LEAF_PAGE);
   SetSize(0);
   SetMaxSize(max_size);
+  next_page_id_ = INVALID_PAGE_ID;
+  has_low_key_ = 0;
 }
 
 /**
@@ -41,6 +44,48 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return nex
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+/*
+ * Helper methods of the B-link fence keys
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::HasLowKey() const -> bool { return has_low_key_ != 0; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetLowKey() const -> KeyType { return low_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetLowKey(const KeyType &key) {
+  low_key_ = key;
+  has_low_key_ = 1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const -> KeyType { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &key) { high_key_ = key; }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::CompareToFences(const KeyType &key, const KeyComparator &comparator) const -> int {
+  if (HasLowKey() && comparator(key, low_key_) < 0) {
+    return -1;
+  }
+  if (next_page_id_ != INVALID_PAGE_ID && comparator(key, high_key_) >= 0) {
+    return 1;
+  }
+  return 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::LinkRightSibling(BPlusTreeLeafPage *sibling, page_id_t sibling_page_id,
+                                                  const KeyType &separator) {
+  sibling->SetLowKey(separator);
+  sibling->SetHighKey(high_key_);
+  sibling->SetNextPageId(next_page_id_);
+  high_key_ = separator;
+  next_page_id_ = sibling_page_id;
+}
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -55,20 +100,29 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType { return
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> int {
-  int l = 0;
-  int r = GetSize() - 1;
-  int ans = r + 1;
-  while (l <= r) {
-    int mid = (l + r) >> 1;
-    if (comparator(array_[mid].first, key) >= 0) {
-      r = mid - 1;
-      ans = mid;
-    } else {
-      l = mid + 1;
-    }
+  return Lookup(key, comparator, GetSize());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::FindValue(const KeyType &key, const KeyComparator &comparator,
+                                            ValueType *value) const -> bool {
+  // 页面可能正在被修改，大小只读一次，并且检查它在页面的范围之内
+  int size = GetSize();
+  if (size < 0 || size > static_cast<int>(LEAF_PAGE_SIZE)) {
+    return false;
   }
-  return ans;  // 总的来说返回的是大于等于key的第一个索引位置
-  // 请注意返回的是第一个大于等于key的index
+  int i = Lookup(key, comparator, size);
+  if (i == size || comparator(array_[i].first, key) != 0) {
+    return false;
+  }
+  *value = array_[i].second;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator, int size) const -> int {
+  // 返回的是第一个大于等于key的index
+  return KeyLowerBound(array_, 0, size, key, comparator);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -167,6 +221,13 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetObjAt(int index) const -> const MappingType
   const MappingType &res = array_[index];
   return res;
 }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Append(const KeyType &key, const ValueType &value) {
+  array_[GetSize()] = std::make_pair(key, value);
+  IncreaseSize(1);
+}
+
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeLeafPage<GenericKey<16>, RID, GenericComparator<16>>;
@@ -6,8 +6,10 @@ namespace bustub {
 BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept {
   this->page_ = that.page_;
   this->bpm_ = that.bpm_;
+  this->is_dirty_ = that.is_dirty_;
   that.page_ = nullptr;
   that.bpm_ = nullptr;
+  that.is_dirty_ = false;
 }
 
 // 使用完这个页面就要告诉缓冲池
@@ -25,13 +27,22 @@ auto BasicPageGuard::operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard
   this->Drop();
   this->page_ = that.page_;
   this->bpm_ = that.bpm_;
+  this->is_dirty_ = that.is_dirty_;
   that.page_ = nullptr;
-  that.page_ = nullptr;
+  that.bpm_ = nullptr;
+  that.is_dirty_ = false;
   return *this;
 }
 
 BasicPageGuard::~BasicPageGuard() { Drop(); };  // NOLINT 自动析构释放锁了
 
+auto BasicPageGuard::UpgradeRead() -> ReadPageGuard {
+  ReadPageGuard read_guard;
+  page_->RLatch();
+  read_guard.guard_ = std::move(*this);
+  return read_guard;
+}
+
 // Read里面有一个basicPageGuard，Read和他们不是继承关系，他也有自己的Drop
 ReadPageGuard::ReadPageGuard(ReadPageGuard &&that) noexcept {
   Drop();
@@ -58,6 +69,21 @@ void ReadPageGuard::Drop() {
 
 ReadPageGuard::~ReadPageGuard() { Drop(); }  // NOLINT
 
+// 升级失败的时候读锁还在，页面也没有被别人改过
+auto ReadPageGuard::TryUpgrade(WritePageGuard *write_guard) -> bool {
+  if (!guard_.page_->TryUpgradeLatch()) {
+    return false;
+  }
+  write_guard->Drop();
+  write_guard->guard_ = std::move(guard_);
+  return true;
+}
+
+auto ReadPageGuard::Downgrade() -> BasicPageGuard {
+  guard_.page_->RUnlatch();
+  return std::move(guard_);
+}
+
 WritePageGuard::WritePageGuard(WritePageGuard &&that) noexcept {
   Drop();
   guard_ = BasicPageGuard(std::move(that.guard_));
@@ -83,4 +109,33 @@ void WritePageGuard::Drop() {
 
 WritePageGuard::~WritePageGuard() { Drop(); }  // NOLINT
 
+// 页面一直pin着，脏标记跟着guard_一起移过去，读锁释放的时候再告诉缓冲池
+auto WritePageGuard::Downgrade() -> ReadPageGuard {
+  ReadPageGuard read_guard;
+  guard_.page_->DowngradeLatch();
+  read_guard.guard_ = std::move(guard_);
+  return read_guard;
+}
+
+OptimisticReadGuard::OptimisticReadGuard(OptimisticReadGuard &&that) noexcept
+    : guard_(std::move(that.guard_)), version_(that.version_) {}
+
+auto OptimisticReadGuard::operator=(OptimisticReadGuard &&that) noexcept -> OptimisticReadGuard & {
+  guard_ = std::move(that.guard_);
+  version_ = that.version_;
+  return *this;
+}
+
+// 乐观读没有加锁，只需要unpin
+void OptimisticReadGuard::Drop() { guard_.Drop(); }
+
+OptimisticReadGuard::~OptimisticReadGuard() { Drop(); }  // NOLINT
+
+auto OptimisticReadGuard::Lock() -> ReadPageGuard {
+  ReadPageGuard read_guard;
+  guard_.page_->RLatch();
+  read_guard.guard_ = std::move(guard_);
+  return read_guard;
+}
+
 }  // namespace bustub
@@ -0,0 +1,84 @@
+/**
+ * arc_replacer_test.cpp
+ */
+
+#include "buffer/arc_replacer.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Load page `page_id` into `frame_id` and unpin it, like the buffer pool does on a miss. */
+void LoadPage(ArcReplacer *replacer, frame_id_t frame_id, page_id_t page_id,
+              AccessType access_type = AccessType::Unknown) {
+  replacer->SetPageId(frame_id, page_id);
+  replacer->RecordAccess(frame_id, access_type);
+  replacer->SetEvictable(frame_id, true);
+}
+
+}  // namespace
+
+TEST(ArcReplacerTest, SampleTest) {
+  ArcReplacer replacer(4);
+  for (frame_id_t frame_id = 1; frame_id <= 4; frame_id++) {
+    LoadPage(&replacer, frame_id, 100 + frame_id);
+  }
+  ASSERT_EQ(4, replacer.Size());
+
+  // Scenario: everything is in T1 and the target size of T1 is 0, so the LRU frame of T1 is evicted.
+  frame_id_t frame_id;
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  // Scenario: a second access moves frame 2 to T2.
+  replacer.RecordAccess(2);
+
+  // Scenario: page 101 is loaded again while it is remembered in B1. T1 grows to 1 and the page goes to T2.
+  LoadPage(&replacer, 1, 101);
+  ASSERT_EQ(4, replacer.Size());
+
+  // T1 = [3, 4] is larger than its target.
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(3, frame_id);
+  // T1 = [4] is not larger than its target any more, so T2 = [2, 1] is evicted in LRU order.
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(2, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(4, frame_id);
+  ASSERT_FALSE(replacer.Evict(&frame_id));
+
+  // Scenario: page 102 was evicted from T2, a miss on it shrinks T1 back to 0 and it goes to T2 again.
+  LoadPage(&replacer, 2, 102);
+  LoadPage(&replacer, 3, 300);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(3, frame_id);
+}
+
+TEST(ArcReplacerTest, ScanResistanceTest) {
+  ArcReplacer replacer(4);
+  frame_id_t frame_id;
+  LoadPage(&replacer, 1, 1);
+  replacer.RecordAccess(1);
+
+  // Scenario: a scan touches every page several times. The scanned pages stay in T1 and are evicted before frame 1.
+  for (page_id_t page_id = 10; page_id < 20; page_id++) {
+    LoadPage(&replacer, 2, page_id, AccessType::Scan);
+    replacer.RecordAccess(2, AccessType::Scan);
+    replacer.RecordAccess(2, AccessType::Scan);
+    ASSERT_TRUE(replacer.Evict(&frame_id));
+    EXPECT_EQ(2, frame_id);
+  }
+
+  // Pinned frames are never evicted.
+  replacer.SetEvictable(1, false);
+  ASSERT_FALSE(replacer.Evict(&frame_id));
+  replacer.SetEvictable(1, true);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+}
+
+}  // namespace bustub
@@ -12,14 +12,36 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_posix.h"
 
 namespace bustub {
 
+// Counts the pages read from disk.
+class CountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+    num_reads_++;
+  }
+  std::atomic<size_t> num_reads_{0};
+};
+
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
 TEST(BufferPoolManagerTest, DISABLED_BinaryDataTest) {
@@ -144,4 +166,839 @@ TEST(BufferPoolManagerTest, DISABLED_SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Check that misses on different pages do their disk I/O in parallel, and that requesters of the same page share one
+// frame
+TEST(BufferPoolManagerTest, ConcurrentMissTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+  const size_t num_threads = 8;
+  const size_t latency_ms = 20;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%zu", i);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  bpm->FlushAllPages();
+  disk_manager->SetLatency(latency_ms);
+
+  // Scenario: every thread misses on its own pages. With the latch held across disk I/O this takes
+  // num_threads * pages_per_thread disk reads back to back.
+  const size_t pages_per_thread = buffer_pool_size / num_threads;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        auto page_idx = tid * pages_per_thread + i;
+        auto guard = bpm->FetchPageRead(page_ids[page_idx]);
+        EXPECT_EQ(std::to_string(page_idx), std::string(guard.GetData()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_LT(elapsed_ms, num_threads * pages_per_thread * latency_ms / 2);
+
+  // Scenario: every thread misses on the same page at the same time. They must all see the same frame and data.
+  const size_t page_idx = num_pages - 1;
+  std::vector<Page *> pages(num_threads);
+  threads.clear();
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      pages[tid] = bpm->FetchPage(page_ids[page_idx]);
+      ASSERT_NE(nullptr, pages[tid]);
+      EXPECT_EQ(std::to_string(page_idx), std::string(pages[tid]->GetData()));
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    EXPECT_EQ(pages[0], pages[tid]);
+  }
+  EXPECT_EQ(num_threads, pages[0]->GetPinCount());
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[page_idx], false));
+  }
+}
+
+// NOLINTNEXTLINE
+// Check that a scan over many pages does not evict pages that are used by point lookups
+TEST(BufferPoolManagerTest, ScanResistanceTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t num_hot_pages = 5;
+  const size_t num_scan_pages = 100;
+
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_hot_pages + num_scan_pages; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: the hot pages are read by point lookups, then every other page is scanned.
+  for (size_t i = 0; i < num_hot_pages; i++) {
+    bpm->FetchPageRead(page_ids[i], AccessType::Get);
+  }
+  for (size_t i = num_hot_pages; i < num_hot_pages + num_scan_pages; i++) {
+    bpm->FetchPageRead(page_ids[i], AccessType::Scan);
+  }
+
+  // Scenario: the hot pages are still in the buffer pool, so reading them again does not go to disk.
+  const size_t num_reads = disk_manager->num_reads_;
+  for (size_t i = 0; i < num_hot_pages; i++) {
+    bpm->FetchPageRead(page_ids[i], AccessType::Get);
+  }
+  EXPECT_EQ(num_reads, disk_manager->num_reads_);
+}
+
+// NOLINTNEXTLINE
+// Check that prefetched pages are loaded in the background and left unpinned
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 32;
+  const size_t num_prefetch_pages = 8;
+
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  // Every page stores the id of the next page, like the pages of a table heap.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    page_ids.push_back(page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < num_pages; i++) {
+    auto guard = bpm->FetchPageWrite(page_ids[i]);
+    *guard.AsMut<page_id_t>() = i + 1 < num_pages ? page_ids[i + 1] : INVALID_PAGE_ID;
+  }
+  // Page 0 to 15 have been evicted by now.
+  auto wait_for_reads = [&](size_t num_reads) {
+    for (int i = 0; i < 1000 && disk_manager->num_reads_ < num_reads; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(num_reads, disk_manager->num_reads_);
+  };
+
+  // Scenario: prefetch a list of pages. They are read once, in the background, and a later fetch is a hit.
+  const size_t num_reads = disk_manager->num_reads_;
+  bpm->PrefetchPages(std::vector<page_id_t>(page_ids.begin(), page_ids.begin() + num_prefetch_pages));
+  wait_for_reads(num_reads + num_prefetch_pages);
+  for (size_t i = 0; i < num_prefetch_pages; i++) {
+    auto guard = bpm->FetchPageRead(page_ids[i], AccessType::Scan);
+    EXPECT_EQ(page_ids[i + 1], *guard.As<page_id_t>());
+  }
+  EXPECT_EQ(num_reads + num_prefetch_pages, disk_manager->num_reads_);
+
+  // Scenario: prefetch a chain of pages by following the next page ids. The pages scanned above are evicted first.
+  bpm->PrefetchPageChain(page_ids[num_prefetch_pages], num_prefetch_pages,
+                         [](const char *page_data) { return *reinterpret_cast<const page_id_t *>(page_data); });
+  wait_for_reads(num_reads + 2 * num_prefetch_pages);
+  for (size_t i = num_prefetch_pages; i < 2 * num_prefetch_pages; i++) {
+    auto guard = bpm->FetchPageRead(page_ids[i], AccessType::Scan);
+    EXPECT_EQ(page_ids[i + 1], *guard.As<page_id_t>());
+  }
+  EXPECT_EQ(num_reads + 2 * num_prefetch_pages, disk_manager->num_reads_);
+
+  // Scenario: prefetched pages are not pinned, so every frame can still be used for new pages.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+}
+
+// NOLINTNEXTLINE
+// Check that the background writer cleans dirty pages before they are evicted
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+  const size_t buffer_pool_size = 8;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  bpm->StartBackgroundWriter(buffer_pool_size, std::chrono::milliseconds(1));
+
+  // Scenario: fill the buffer pool with dirty pages. Once they are unpinned, the writer writes all of them back.
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%zu", i);
+    page_ids.push_back(page_id);
+  }
+  // The writer must leave pinned pages alone.
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(0, bpm->GetBackgroundWriteCount());
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (int i = 0; i < 1000 && bpm->GetBackgroundWriteCount() < buffer_pool_size; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundWriteCount());
+  bpm->StopBackgroundWriter();
+
+  // Scenario: evicting the cleaned pages does not write them again, and their data is on disk.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundWriteCount());
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto guard = bpm->FetchPageRead(page_ids[i]);
+    EXPECT_EQ(std::to_string(i), std::string(guard.GetData()));
+  }
+}
+
+// NOLINTNEXTLINE
+// Check that the buffer pool returns the right data with every replacement policy
+TEST(BufferPoolManagerTest, ReplacerTypeTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t num_pages = 50;
+
+  for (auto replacer_type :
+       {ReplacerType::LRUK, ReplacerType::LRU, ReplacerType::Clock, ReplacerType::TwoQ, ReplacerType::ARC}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), LRUK_REPLACER_K, nullptr,
+                                                   replacer_type);
+
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto guard = bpm->NewPageGuarded(&page_id);
+      ASSERT_NE(INVALID_PAGE_ID, page_id);
+      snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "%zu", i);
+      page_ids.push_back(page_id);
+    }
+
+    // Scenario: a mix of skewed and uniform reads, with some pages kept pinned in between.
+    std::default_random_engine gen(0);
+    std::uniform_int_distribution<size_t> uniform(0, num_pages - 1);
+    std::uniform_int_distribution<size_t> hot(0, buffer_pool_size / 2 - 1);
+    std::vector<ReadPageGuard> pinned;
+    for (size_t round = 0; round < 1000; round++) {
+      const size_t i = round % 3 == 0 ? uniform(gen) : hot(gen);
+      auto guard = bpm->FetchPageRead(page_ids[i], round % 5 == 0 ? AccessType::Scan : AccessType::Get);
+      ASSERT_EQ(std::to_string(i), std::string(guard.GetData()));
+      if (round % 7 == 0) {
+        pinned.push_back(std::move(guard));
+      }
+      if (pinned.size() == buffer_pool_size / 2) {
+        pinned.clear();
+      }
+    }
+
+    // Scenario: every frame can be used once all pages are unpinned.
+    pinned.clear();
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      page_id_t page_id;
+      EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+// Check that the arena layouts keep all frames in one page aligned region and behave like the per-page layout
+TEST(BufferPoolManagerTest, FrameArenaTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 64;
+  const FrameLayout default_layout = buffer_pool_frame_layout;
+
+  for (auto layout : {FrameLayout::Arena, FrameLayout::HugeTlbArena}) {
+    buffer_pool_frame_layout = layout;
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+    // Scenario: the frames of a full buffer pool are page aligned, zeroed and lie in one region.
+    std::vector<page_id_t> page_ids;
+    std::vector<char *> frames;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page->GetData()) % BUSTUB_PAGE_SIZE);
+      EXPECT_EQ(0, page->GetData()[BUSTUB_PAGE_SIZE - 1]);
+      frames.push_back(page->GetData());
+      page_ids.push_back(page_id);
+    }
+    std::sort(frames.begin(), frames.end());
+    EXPECT_EQ((buffer_pool_size - 1) * BUSTUB_PAGE_SIZE, static_cast<size_t>(frames.back() - frames.front()));
+
+    // Scenario: pages survive eviction and are zeroed when a frame is reused for a new page.
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      snprintf(bpm->FetchPage(page_ids[i])->GetData(), BUSTUB_PAGE_SIZE, "%zu", i);
+      EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+      EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+    }
+    for (size_t i = buffer_pool_size; i < num_pages; i++) {
+      page_id_t page_id;
+      auto guard = bpm->NewPageGuarded(&page_id);
+      EXPECT_EQ(0, guard.GetData()[0]);
+      snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "%zu", i);
+      page_ids.push_back(page_id);
+    }
+    for (size_t i = 0; i < num_pages; i++) {
+      auto guard = bpm->FetchPageRead(page_ids[i]);
+      EXPECT_EQ(std::to_string(i), std::string(guard.GetData()));
+    }
+  }
+  buffer_pool_frame_layout = default_layout;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FreePageReuseTest) {
+  const size_t buffer_pool_size = 4;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+  auto *free_page_map = disk_manager->GetFreePageMap();
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 8; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  // Scenario: a pinned page cannot be deleted, an evicted one can.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[7]));
+  EXPECT_FALSE(bpm->DeletePage(page_ids[7]));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[7], false));
+  EXPECT_TRUE(bpm->DeletePage(page_ids[1]));
+  EXPECT_TRUE(bpm->DeletePage(page_ids[5]));
+  EXPECT_TRUE(bpm->DeletePage(page_ids[6]));
+  EXPECT_EQ(3, free_page_map->GetNumFreePages());
+
+  // Scenario: deleted pages are reused, the one closest to the hint first, then the lowest one.
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id, page_ids[7]));
+  EXPECT_EQ(page_ids[6], page_id);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(page_ids[1], page_id);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(page_ids[5], page_id);
+  EXPECT_EQ(0, free_page_map->GetNumFreePages());
+
+  // Scenario: a full pool gives the page it took from the map back.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(page_ids[7] + 1, page_id);
+  EXPECT_TRUE(bpm->DeletePage(page_ids[2]));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(1, free_page_map->GetNumFreePages());
+
+  // Scenario: a deleted page that was fetched again is not mapped twice when its page id is reused.
+  for (auto id : {page_id, page_ids[6]}) {
+    EXPECT_TRUE(bpm->UnpinPage(id, false));
+  }
+  auto *stale_page = bpm->FetchPage(page_ids[2]);
+  ASSERT_NE(nullptr, stale_page);
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[2], false));
+  auto *new_page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, new_page);
+  EXPECT_EQ(page_ids[2], page_id);
+  snprintf(new_page->GetData(), BUSTUB_PAGE_SIZE, "reused");
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  auto *fetched_page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, fetched_page);
+  EXPECT_STREQ("reused", fetched_page->GetData());
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: a pinned stale copy keeps its page id, the new page gets another one.
+  EXPECT_TRUE(bpm->DeletePage(page_ids[2]));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[2]));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_NE(page_ids[2], page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[2], false));
+
+  // Scenario: deleting a page id that was never allocated, or an invalid one, does not free it.
+  size_t num_free_pages = free_page_map->GetNumFreePages();
+  EXPECT_TRUE(bpm->DeletePage(INVALID_PAGE_ID));
+  EXPECT_TRUE(bpm->DeletePage(100));
+  EXPECT_TRUE(bpm->DeletePage(1));
+  EXPECT_EQ(num_free_pages, free_page_map->GetNumFreePages());
+  auto fresh_disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto fresh_bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, fresh_disk_manager.get());
+  ASSERT_NE(nullptr, fresh_bpm->NewPage(&page_id));
+  EXPECT_TRUE(fresh_bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(fresh_bpm->DeletePage(5));
+  std::set<page_id_t> new_page_ids;
+  for (size_t i = 0; i < 6; i++) {
+    ASSERT_NE(nullptr, fresh_bpm->NewPage(&page_id));
+    EXPECT_TRUE(fresh_bpm->UnpinPage(page_id, false));
+    EXPECT_TRUE(new_page_ids.insert(page_id).second) << page_id;
+  }
+
+  // Scenario: a reused page reads as zeros after it was evicted clean, not as the page that was deleted.
+  fresh_disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  fresh_bpm = std::make_unique<BufferPoolManager>(1, fresh_disk_manager.get());
+  page_id_t old_page_id;
+  auto *old_page = fresh_bpm->NewPage(&old_page_id);
+  ASSERT_NE(nullptr, old_page);
+  snprintf(old_page->GetData(), BUSTUB_PAGE_SIZE, "old data");
+  EXPECT_TRUE(fresh_bpm->UnpinPage(old_page_id, true));
+  ASSERT_NE(nullptr, fresh_bpm->NewPage(&page_id));
+  EXPECT_TRUE(fresh_bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(fresh_bpm->DeletePage(old_page_id));
+  ASSERT_NE(nullptr, fresh_bpm->NewPage(&page_id));
+  EXPECT_EQ(old_page_id, page_id);
+  EXPECT_TRUE(fresh_bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, fresh_bpm->NewPage(&page_id));
+  EXPECT_TRUE(fresh_bpm->UnpinPage(page_id, false));
+  auto *reused_page = fresh_bpm->FetchPage(old_page_id);
+  ASSERT_NE(nullptr, reused_page);
+  EXPECT_STREQ("", reused_page->GetData());
+  EXPECT_TRUE(fresh_bpm->UnpinPage(old_page_id, false));
+
+  // Scenario: every instance of a parallel pool only gets back the pages it owns.
+  FreePageMap map(nullptr, 0, false);
+  map.Free(2);
+  map.Free(3);
+  EXPECT_EQ(3, map.Allocate(INVALID_PAGE_ID, 2, 1));
+  EXPECT_EQ(INVALID_PAGE_ID, map.Allocate(INVALID_PAGE_ID, 2, 1));
+  EXPECT_EQ(2, map.Allocate(INVALID_PAGE_ID, 2, 0));
+  EXPECT_FALSE(FreePageMap::IsMapPage(0));
+  EXPECT_TRUE(FreePageMap::IsMapPage(1));
+  EXPECT_TRUE(FreePageMap::IsMapPage(FreePageMap::PAGES_PER_GROUP + 1));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FreePageMapPersistenceTest) {
+  const std::string db_name = "free_page_map_test.db";
+  {
+    auto disk_manager = std::make_unique<DiskManager>(db_name);
+    auto bpm = std::make_unique<BufferPoolManager>(10, disk_manager.get());
+    for (size_t i = 0; i < 3; i++) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+    EXPECT_TRUE(bpm->DeletePage(2));
+    disk_manager->ShutDown();
+  }
+
+  // Scenario: the map page of the first group is the second page, so freeing a page does not grow the file.
+  EXPECT_EQ(4 * BUSTUB_PAGE_SIZE, std::filesystem::file_size(db_name));
+
+  // Scenario: the free pages survive a restart.
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManager>(10, disk_manager.get());
+  EXPECT_EQ(1, disk_manager->GetFreePageMap()->GetNumFreePages());
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(2, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+
+  // Scenario: pages that were in the file before the restart can be freed, and new page ids start after them.
+  EXPECT_TRUE(bpm->DeletePage(3));
+  EXPECT_EQ(1, disk_manager->GetFreePageMap()->GetNumFreePages());
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(3, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(4, page_id);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove("free_page_map_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, BatchFetchTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t latency_ms = 20;
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  std::vector<page_id_t> page_ids;
+  auto guards = bpm->NewPagesGuarded(buffer_pool_size, &page_ids);
+  ASSERT_EQ(buffer_pool_size, guards.size());
+  ASSERT_EQ(buffer_pool_size, page_ids.size());
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    EXPECT_EQ(page_ids[i], guards[i].PageId());
+    snprintf(guards[i].AsMut<char>(), BUSTUB_PAGE_SIZE, "%zu", i);
+  }
+
+  // Scenario: every frame is pinned, so a batch of new pages gets none.
+  std::vector<page_id_t> more_page_ids;
+  EXPECT_TRUE(bpm->NewPages(2, &more_page_ids).empty());
+  EXPECT_TRUE(more_page_ids.empty());
+  guards.clear();
+  bpm->FlushAllPages();
+
+  // Scenario: evict half of the pages, then fetch all of them and one page twice in one batch. The misses are read
+  // concurrently, so the batch takes about one disk latency instead of one per miss.
+  std::vector<page_id_t> half_page_ids;
+  ASSERT_EQ(buffer_pool_size / 2, bpm->NewPagesGuarded(buffer_pool_size / 2, &half_page_ids).size());
+  for (auto page_id : half_page_ids) {
+    EXPECT_TRUE(bpm->DeletePage(page_id));
+  }
+  disk_manager->SetLatency(latency_ms);
+  disk_manager->num_reads_ = 0;
+  std::vector<page_id_t> fetch_page_ids(page_ids);
+  fetch_page_ids.push_back(page_ids[0]);
+  fetch_page_ids.push_back(INVALID_PAGE_ID);
+  auto start = std::chrono::steady_clock::now();
+  {
+    auto read_guards = bpm->FetchPagesRead(fetch_page_ids);
+    auto elapsed_ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_LT(elapsed_ms, buffer_pool_size / 2 * latency_ms / 2);
+    EXPECT_EQ(buffer_pool_size / 2, disk_manager->num_reads_);
+    ASSERT_EQ(fetch_page_ids.size(), read_guards.size());
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      EXPECT_EQ(std::to_string(i), std::string(read_guards[i].GetData()));
+    }
+    EXPECT_EQ(read_guards[0].GetData(), read_guards[buffer_pool_size].GetData());
+  }
+  EXPECT_EQ(nullptr, bpm->FetchPages({INVALID_PAGE_ID})[0]);
+  disk_manager->SetLatency(0);
+
+  // Scenario: the batch released every pin.
+  for (auto page_id : page_ids) {
+    EXPECT_FALSE(bpm->UnpinPage(page_id, false));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, StatsTest) {
+  const size_t buffer_pool_size = 2;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 3; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+  // Scenario: page 2 is a hit, page 0 was evicted (and written back) to make room for page 2 and is a miss.
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[2]));
+  ASSERT_NE(nullptr, bpm->FetchPage(page_ids[0]));
+  page_id_t page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(0, stats.free_frames_);
+  EXPECT_EQ(2, stats.pinned_frames_);
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(3, stats.new_pages_);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(1, stats.all_pinned_);
+  EXPECT_EQ(2, stats.dirty_write_backs_);
+  EXPECT_EQ(stats.dirty_write_backs_, bpm->GetForegroundWriteCount());
+  EXPECT_EQ(2, stats.replacer_.evictions_);
+  EXPECT_EQ(1, stats.replacer_.failed_evictions_);
+  EXPECT_LT(0, stats.latch_acquisitions_);
+  EXPECT_LT(0, stats.latch_hold_ns_);
+
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[2], false));
+  EXPECT_TRUE(bpm->UnpinPage(page_ids[0], false));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ResizeTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t num_pages = 16;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  std::vector<page_id_t> page_ids;
+  auto new_page = [&](size_t i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      return false;
+    }
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%zu", i);
+    page_ids.push_back(page_id);
+    return true;
+  };
+
+  // Scenario: a full pool takes more pinned pages after it grew.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_TRUE(new_page(i));
+  }
+  ASSERT_FALSE(new_page(buffer_pool_size));
+  ASSERT_TRUE(bpm->Resize(2 * buffer_pool_size));
+  EXPECT_EQ(2 * buffer_pool_size, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < 2 * buffer_pool_size; i++) {
+    ASSERT_TRUE(new_page(i));
+  }
+  ASSERT_FALSE(new_page(2 * buffer_pool_size));
+
+  // Scenario: shrinking is refused while the frames to remove are pinned, and writes back their dirty pages.
+  EXPECT_FALSE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(2 * buffer_pool_size, bpm->GetPoolSize());
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  ASSERT_TRUE(bpm->Resize(1));
+  EXPECT_EQ(1, bpm->GetPoolSize());
+  EXPECT_FALSE(bpm->Resize(0));
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    auto guard = bpm->FetchPageRead(page_ids[i]);
+    EXPECT_EQ(std::to_string(i), std::string(guard.GetData()));
+  }
+
+  // Scenario: the pool is resized back and forth while other threads fetch pages.
+  for (size_t i = page_ids.size(); i < num_pages; i++) {
+    ASSERT_TRUE(bpm->Resize(page_ids.size() + 1));
+    ASSERT_TRUE(new_page(i));
+    EXPECT_TRUE(bpm->UnpinPage(page_ids.back(), true));
+  }
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < 4; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      while (!stop) {
+        const size_t i = gen() % num_pages;
+        auto *page = bpm->FetchPage(page_ids[i]);
+        if (page == nullptr) {
+          continue;
+        }
+        page->RLatch();
+        EXPECT_EQ(std::to_string(i), std::string(page->GetData()));
+        page->RUnlatch();
+        bpm->UnpinPage(page_ids[i], false);
+      }
+    });
+  }
+  // A shrink may be refused whenever a reader has one of the frames to remove pinned.
+  for (size_t round = 0; round < 200; round++) {
+    EXPECT_TRUE(bpm->Resize(num_pages));
+    bpm->Resize(8 + round % 4);
+  }
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(bpm->Resize(8));
+  for (size_t i = 0; i < num_pages; i++) {
+    auto guard = bpm->FetchPageRead(page_ids[i]);
+    EXPECT_EQ(std::to_string(i), std::string(guard.GetData()));
+  }
+
+  // Scenario: the pool keeps growing one frame at a time, far more often than it has segments.
+  for (size_t size = num_pages + 1; size <= num_pages + 1000; size++) {
+    ASSERT_TRUE(bpm->Resize(size));
+  }
+  EXPECT_EQ(num_pages + 1000, bpm->GetPoolSize());
+  for (size_t i = 0; i < num_pages; i++) {
+    auto guard = bpm->FetchPageRead(page_ids[i]);
+    EXPECT_EQ(std::to_string(i), std::string(guard.GetData()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, LockFreeHitTest) {
+  const size_t buffer_pool_size = 4;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Scenario: fetching and unpinning a resident page does not take the buffer pool latch.
+  const auto latch_acquisitions = bpm->GetStats().latch_acquisitions_;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_EQ(page, bpm->FetchPage(page_id));
+    EXPECT_EQ(page, bpm->FetchPage(page_id));
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_FALSE(bpm->UnpinPage(page_id, false));
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(latch_acquisitions + 1, stats.latch_acquisitions_);  // GetStats() itself
+  EXPECT_EQ(200, stats.hits_);
+  EXPECT_TRUE(page->IsDirty());
+
+  // Scenario: a page pinned by a hit is not evicted, even though the replacer learns about the hit late.
+  EXPECT_EQ(page, bpm->FetchPage(page_id));
+  for (int i = 0; i < 10; i++) {
+    page_id_t other_page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&other_page_id));
+    EXPECT_TRUE(bpm->UnpinPage(other_page_id, false));
+  }
+  EXPECT_EQ(page_id, page->GetPageId());
+  EXPECT_EQ(0, strcmp(page->GetData(), "Hello"));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  EXPECT_TRUE(bpm->DeletePage(page_id));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, ConcurrentHitMissTest) {
+  // Many more pages than frames, so that lock-free hits race with evictions of the same frames.
+  const size_t buffer_pool_size = 8;
+  const size_t num_pages = 32;
+  const int num_threads = 8;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    page_ids.push_back(page_id);
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      std::mt19937 gen(t);
+      // Half of the accesses go to a few hot pages, which mostly hit.
+      std::uniform_int_distribution<size_t> page_dist(0, num_pages - 1);
+      for (int i = 0; i < 5000; i++) {
+        const size_t index = i % 2 == 0 ? page_dist(gen) % 4 : page_dist(gen);
+        const page_id_t page_id = page_ids[index];
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;  // every frame pinned
+        }
+        ASSERT_EQ(page_id, page->GetPageId());
+        page->RLatch();
+        ASSERT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        page->RUnlatch();
+        ASSERT_TRUE(bpm->UnpinPage(page_id, i % 7 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.pinned_frames_);
+  EXPECT_LT(0, stats.hits_);
+  EXPECT_LT(0, stats.evictions_);
+  for (size_t i = 0; i < num_pages; i++) {
+    auto guard = bpm->FetchPageRead(page_ids[i]);
+    EXPECT_EQ(std::to_string(page_ids[i]), std::string(guard.GetData()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "flush_all_pages_test.db";
+  remove(db_name.c_str());
+  const size_t num_pages = 32;
+  auto disk_manager = std::make_unique<DiskManagerPosix>(db_name);
+  auto bpm = std::make_unique<BufferPoolManager>(num_pages * 2, disk_manager.get());
+
+  // The header page stays clean, the pages after it and the map page of the first group are the test pages.
+  page_id_t header_page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&header_page_id));
+  EXPECT_TRUE(bpm->UnpinPage(header_page_id, false));
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    page_ids.push_back(page_id);
+  }
+  // Dirty the pages in a shuffled order, half of them still pinned: the pages are written in page id order anyway.
+  std::shuffle(page_ids.begin(), page_ids.end(), std::mt19937(15445));
+  for (size_t i = num_pages / 2; i < num_pages; i++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_ids[i]));
+  }
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: the new pages are adjacent on disk, so they go out in one write call and one sync.
+  bpm->FlushAllPages();
+  auto stats = disk_manager->GetStats();
+  EXPECT_EQ(num_pages, stats.pages_written_);
+  EXPECT_EQ(num_pages * BUSTUB_PAGE_SIZE, stats.bytes_written_);
+  EXPECT_EQ(1, stats.write_calls_);
+  EXPECT_EQ(1, stats.syncs_);
+  EXPECT_LT(0, stats.PagesPerSecond());
+
+  // Scenario: clean pages are not written again.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_pages, disk_manager->GetStats().pages_written_);
+
+  // Scenario: the flushed pages can be read back by another buffer pool.
+  for (size_t i = num_pages / 2; i < num_pages; i++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], false));
+  }
+  bpm = std::make_unique<BufferPoolManager>(num_pages, disk_manager.get());
+  for (auto page_id : page_ids) {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(std::to_string(page_id), std::string(guard.GetData()));
+  }
+
+  bpm = nullptr;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove("flush_all_pages_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, MmapReadOnlyTest) {
+  const std::string db_name = "mmap_read_only_test.db";
+  remove(db_name.c_str());
+  const size_t num_pages = 256;
+  std::vector<page_id_t> page_ids;
+  {
+    DiskManagerPosix writer(db_name);
+    BufferPoolManager bpm(16, &writer);
+    for (size_t i = 0; i < num_pages; i++) {
+      page_id_t page_id;
+      auto guard = bpm.NewPageGuarded(&page_id);
+      snprintf(guard.GetDataMut(), BUSTUB_PAGE_SIZE, "%d", page_id);
+      page_ids.push_back(page_id);
+    }
+    bpm.FlushAllPages();
+    writer.ShutDown();
+  }
+
+  // Scenario: a buffer pool over the read-only mapping serves scans and lookups, and evicts clean pages.
+  DiskManagerMmap disk_manager(db_name);
+  BufferPoolManager bpm(16, &disk_manager);
+  for (auto page_id : page_ids) {
+    auto guard = bpm.FetchPageRead(page_id, AccessType::Scan);
+    EXPECT_EQ(std::to_string(page_id), std::string(guard.GetData()));
+  }
+  for (page_id_t page_id : {page_ids[7], page_ids[200], page_ids[42]}) {
+    auto guard = bpm.FetchPageRead(page_id, AccessType::Get);
+    EXPECT_EQ(std::to_string(page_id), std::string(guard.GetData()));
+  }
+
+  disk_manager.ShutDown();
+  remove(db_name.c_str());
+  remove("mmap_read_only_test.log");
+}
+
 }  // namespace bustub
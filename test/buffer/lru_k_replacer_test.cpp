@@ -95,4 +95,153 @@ TEST(LRUKReplacerTest, DISABLED_SampleTest) {
   ASSERT_EQ(false, lru_replacer.Evict(&value));
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, BackwardKDistanceTest) {
+  LRUKReplacer lru_replacer(8, 2);
+
+  // Scenario: frames 1, 2 and 3 are accessed twice, in an order where the most recent access and the second most
+  // recent access disagree. Access sequence: 1 2 3 3 2 1, so the second most recent accesses are 1@0, 2@1, 3@2.
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(1);
+  // Frame 4 has a single access, so it has +inf backward k-distance.
+  lru_replacer.RecordAccess(4);
+  for (frame_id_t frame_id = 1; frame_id <= 4; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(4, lru_replacer.Size());
+
+  // Frame 1 is evicted right after frame 4 because its second most recent access is the oldest, although it has the
+  // most recent access of all.
+  int value;
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(4, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // Scenario: a frame that is pinned and unpinned again keeps its place in the eviction order.
+  lru_replacer.SetEvictable(2, false);
+  ASSERT_EQ(1, lru_replacer.Size());
+  lru_replacer.SetEvictable(2, true);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+
+  // Scenario: an evicted frame starts with an empty history. Frame 8 (== num_frames) is a valid frame id.
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(8);
+  lru_replacer.RecordAccess(8);
+  lru_replacer.SetEvictable(2, true);
+  lru_replacer.SetEvictable(8, true);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_TRUE(lru_replacer.Evict(&value));
+  ASSERT_EQ(8, value);
+  ASSERT_FALSE(lru_replacer.Evict(&value));
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(LRUKReplacerTest, MostlyPinnedTest) {
+  const size_t num_frames = 1000;
+  LRUKReplacer lru_replacer(num_frames, 3);
+
+  // Scenario: every frame is accessed, and only every tenth frame is evictable. Eviction must follow the access order
+  // of the evictable frames.
+  for (size_t i = 0; i < num_frames; i++) {
+    lru_replacer.RecordAccess(static_cast<frame_id_t>(i));
+  }
+  for (size_t i = 0; i < num_frames; i += 10) {
+    lru_replacer.SetEvictable(static_cast<frame_id_t>(i), true);
+  }
+  ASSERT_EQ(num_frames / 10, lru_replacer.Size());
+  for (size_t i = 0; i < num_frames; i += 10) {
+    int value;
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(static_cast<frame_id_t>(i), value);
+  }
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  LRUKReplacer lru_replacer(10, 2);
+
+  // Scenario: frames 1 and 2 are hot pages accessed once by point lookups, and frames 3 to 6 are filled by a scan
+  // afterwards. Plain LRU-K would evict 1 and 2 first since they are the oldest frames with +inf backward k-distance.
+  lru_replacer.RecordAccess(1, AccessType::Get);
+  lru_replacer.RecordAccess(2, AccessType::Get);
+  for (frame_id_t frame_id = 3; frame_id <= 6; frame_id++) {
+    lru_replacer.RecordAccess(frame_id, AccessType::Scan);
+  }
+  // Frame 2 is touched by the scan as well, which must not make it cold.
+  lru_replacer.RecordAccess(2, AccessType::Scan);
+  // Frame 6 is used by a point lookup after the scan, so it is no longer cold.
+  lru_replacer.RecordAccess(6, AccessType::Get);
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  ASSERT_EQ(6, lru_replacer.Size());
+
+  // The scanned frames are evicted first, in scan order, then the rest in LRU-K order.
+  int value;
+  for (frame_id_t expected : {3, 4, 5, 1, 2, 6}) {
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_EQ(0, lru_replacer.Size());
+}
+
+TEST(LRUKReplacerTest, PrefetchTest) {
+  LRUKReplacer lru_replacer(10, 2);
+
+  // Scenario: frame 1 is scanned, then frames 2 and 3 are prefetched ahead of the scan. The prefetched frames must
+  // not be evicted before the frame the scan is done with.
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+  lru_replacer.RecordAccess(2, AccessType::Prefetch);
+  lru_replacer.RecordAccess(3, AccessType::Prefetch);
+  // Frame 4 is a point lookup older than the scan of frame 2 below.
+  lru_replacer.RecordAccess(4, AccessType::Get);
+  // The scan reaches frame 2, which becomes cold. A second prefetch of frame 3 changes nothing.
+  lru_replacer.RecordAccess(2, AccessType::Scan);
+  lru_replacer.RecordAccess(3, AccessType::Prefetch);
+  for (frame_id_t frame_id = 1; frame_id <= 4; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+
+  int value;
+  for (frame_id_t expected : {1, 2, 3, 4}) {
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+}
+TEST(LRUKReplacerTest, StatsTest) {
+  LRUKReplacer lru_replacer(10, 2);
+
+  // Scenario: one frame of each kind is evicted: scanned, prefetched and unused, accessed once, accessed k times.
+  lru_replacer.RecordAccess(1, AccessType::Scan);
+  lru_replacer.RecordAccess(2, AccessType::Prefetch);
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(4);
+  lru_replacer.RecordAccess(4);
+  for (frame_id_t frame_id = 1; frame_id <= 4; frame_id++) {
+    lru_replacer.SetEvictable(frame_id, true);
+  }
+  int value;
+  for (int i = 0; i < 4; i++) {
+    ASSERT_TRUE(lru_replacer.Evict(&value));
+  }
+  ASSERT_FALSE(lru_replacer.Evict(&value));
+
+  auto stats = lru_replacer.GetStats();
+  EXPECT_EQ(5, stats.accesses_);
+  EXPECT_EQ(4, stats.evictions_);
+  EXPECT_EQ(1, stats.cold_evictions_);
+  EXPECT_EQ(1, stats.unused_prefetch_evictions_);
+  EXPECT_EQ(1, stats.evictions_below_k_);
+  EXPECT_EQ(1, stats.failed_evictions_);
+}
 }  // namespace bustub
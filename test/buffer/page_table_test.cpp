@@ -0,0 +1,135 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(4);
+  frame_id_t frame_id;
+  EXPECT_FALSE(page_table.Find(1, &frame_id));
+
+  page_table.Insert(1, 0);
+  page_table.Insert(2, 1);
+  page_table.Insert(3, 2);
+  EXPECT_EQ(3, page_table.Size());
+  ASSERT_TRUE(page_table.Find(2, &frame_id));
+  EXPECT_EQ(1, frame_id);
+
+  // Scenario: mapping a page again replaces its frame.
+  page_table.Insert(2, 3);
+  EXPECT_EQ(3, page_table.Size());
+  ASSERT_TRUE(page_table.Find(2, &frame_id));
+  EXPECT_EQ(3, frame_id);
+
+  page_table.Erase(2);
+  page_table.Erase(42);
+  EXPECT_EQ(2, page_table.Size());
+  EXPECT_FALSE(page_table.Find(2, &frame_id));
+  ASSERT_TRUE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(2, frame_id);
+
+  // Scenario: growing the table keeps the entries.
+  page_table.Reserve(1000);
+  ASSERT_TRUE(page_table.Find(1, &frame_id));
+  EXPECT_EQ(0, frame_id);
+  ASSERT_TRUE(page_table.Find(3, &frame_id));
+  EXPECT_EQ(2, frame_id);
+}
+
+TEST(PageTableTest, RandomTest) {
+  // Many inserts and erases in a small table, so that probe sequences overlap and erases shift entries around.
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 255);
+
+  for (int i = 0; i < 100000; i++) {
+    const page_id_t page_id = page_dist(gen);
+    if (expected.count(page_id) == 0 && expected.size() < num_frames) {
+      const auto frame_id = static_cast<frame_id_t>(i % num_frames);
+      page_table.Insert(page_id, frame_id);
+      expected[page_id] = frame_id;
+    } else {
+      page_table.Erase(page_id);
+      expected.erase(page_id);
+    }
+    ASSERT_EQ(expected.size(), page_table.Size());
+  }
+  for (page_id_t page_id = 0; page_id < 256; page_id++) {
+    frame_id_t frame_id;
+    auto it = expected.find(page_id);
+    ASSERT_EQ(it != expected.end(), page_table.Find(page_id, &frame_id));
+    if (it != expected.end()) {
+      EXPECT_EQ(it->second, frame_id);
+    }
+  }
+}
+
+TEST(PageTableTest, ConcurrentFindTest) {
+  // Scenario: readers look up pages that are never erased while a writer inserts and erases other pages around them.
+  // A lookup may miss while entries are being shifted, but must never return a wrong frame.
+  const size_t num_frames = 64;
+  const page_id_t num_stable = 16;
+  PageTable page_table(num_frames);
+  for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+    page_table.Insert(page_id, page_id);
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<size_t> num_found{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; t++) {
+    readers.emplace_back([&] {
+      size_t found = 0;
+      while (!stop) {
+        for (page_id_t page_id = 0; page_id < num_stable; page_id++) {
+          frame_id_t frame_id;
+          if (page_table.Find(page_id, &frame_id)) {
+            ASSERT_EQ(page_id, frame_id);
+            found++;
+          }
+        }
+      }
+      num_found += found;
+    });
+  }
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<page_id_t> page_dist(num_stable, num_stable + 100);
+  for (int i = 0; i < 200000; i++) {
+    const page_id_t page_id = page_dist(gen);
+    frame_id_t frame_id;
+    if (!page_table.Find(page_id, &frame_id) && page_table.Size() < num_frames) {
+      page_table.Insert(page_id, static_cast<frame_id_t>(1000 + page_id));
+    } else {
+      page_table.Erase(page_id);
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_LT(0, num_found);
+}
+
+}  // namespace bustub
@@ -0,0 +1,189 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_posix.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 10;
+  const size_t k = 5;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get(), k);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+  snprintf(page0->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: We should be able to create new pages until we fill up every instance, and all page ids are distinct.
+  std::set<page_id_t> page_ids{page_id_temp};
+  for (size_t i = 1; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(page_ids.insert(page_id_temp).second);
+  }
+
+  // Scenario: Once every instance is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: After unpinning every page, new pages can be created again and page 0 is written back on eviction.
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: We should be able to fetch the data we wrote a while ago, through the page guards as well.
+  {
+    auto guard = bpm->FetchPageRead(0);
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+  }
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(1, page0->GetPinCount());
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_FALSE(bpm->UnpinPage(0, false));
+
+  EXPECT_TRUE(bpm->DeletePage(0));
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrentTest) {
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 16;
+  const size_t num_threads = 8;
+  const size_t pages_per_thread = 50;
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get());
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&bpm, tid] {
+      std::vector<page_id_t> page_ids;
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        auto guard = bpm->NewPageGuarded(&page_id);
+        ASSERT_NE(INVALID_PAGE_ID, page_id);
+        snprintf(guard.AsMut<char>(), BUSTUB_PAGE_SIZE, "%zu-%zu", tid, i);
+        page_ids.push_back(page_id);
+      }
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        auto guard = bpm->FetchPageRead(page_ids[i]);
+        EXPECT_EQ(std::to_string(tid) + "-" + std::to_string(i), std::string(guard.GetData()));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, BatchTest) {
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 4;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get());
+
+  // Scenario: a batch larger than one instance spills over to the next instances.
+  std::vector<page_id_t> page_ids;
+  auto pages = bpm->NewPages(6, &page_ids);
+  ASSERT_EQ(6, pages.size());
+  for (size_t i = 0; i < pages.size(); i++) {
+    snprintf(pages[i]->GetData(), BUSTUB_PAGE_SIZE, "%zu", i);
+    EXPECT_TRUE(bpm->UnpinPage(page_ids[i], true));
+  }
+
+  // Scenario: a batch fetch over several instances returns the pages in the order they were asked for.
+  std::vector<page_id_t> reversed(page_ids.rbegin(), page_ids.rend());
+  auto guards = bpm->FetchPagesRead(reversed);
+  ASSERT_EQ(reversed.size(), guards.size());
+  for (size_t i = 0; i < guards.size(); i++) {
+    EXPECT_EQ(reversed[i], guards[i].PageId());
+    EXPECT_EQ(std::to_string(reversed.size() - 1 - i), std::string(guards[i].GetData()));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const size_t num_instances = 4;
+  const size_t buffer_pool_size = 2;
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, buffer_pool_size, disk_manager.get());
+
+  // Scenario: the frames are split over the instances, and every instance needs at least one.
+  ASSERT_TRUE(bpm->Resize(10));
+  EXPECT_EQ(10, bpm->GetPoolSize());
+  EXPECT_FALSE(bpm->Resize(num_instances - 1));
+  ASSERT_TRUE(bpm->Resize(num_instances));
+  EXPECT_EQ(num_instances, bpm->GetPoolSize());
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "parallel_flush_all_pages_test.db";
+  remove(db_name.c_str());
+  const size_t num_instances = 4;
+  const size_t num_pages = 32;
+  auto disk_manager = std::make_unique<DiskManagerPosix>(db_name);
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_instances, num_pages, disk_manager.get());
+
+  for (size_t i = 0; i < num_pages * 2; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  // Page 1 is the map page of the first group, so only dirty a contiguous run of pages after it.
+  for (auto page_id = static_cast<page_id_t>(num_pages); page_id < static_cast<page_id_t>(num_pages * 2); page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: adjacent pages live in different instances, but are still written together.
+  bpm->FlushAllPages();
+  auto stats = disk_manager->GetStats();
+  EXPECT_EQ(num_pages, stats.pages_written_);
+  EXPECT_EQ(1, stats.write_calls_);
+  EXPECT_EQ(1, stats.syncs_);
+
+  bpm = nullptr;
+  disk_manager->ShutDown();
+  remove(db_name.c_str());
+  remove("parallel_flush_all_pages_test.log");
+}
+
+}  // namespace bustub
@@ -0,0 +1,110 @@
+/**
+ * two_q_replacer_test.cpp
+ */
+
+#include "buffer/two_q_replacer.h"
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+namespace {
+
+/** Load page `page_id` into `frame_id` and unpin it, like the buffer pool does on a miss. */
+void LoadPage(TwoQReplacer *replacer, frame_id_t frame_id, page_id_t page_id) {
+  replacer->SetPageId(frame_id, page_id);
+  replacer->RecordAccess(frame_id);
+  replacer->SetEvictable(frame_id, true);
+}
+
+}  // namespace
+
+TEST(TwoQReplacerTest, SampleTest) {
+  // Kin = 2 frames, Kout = 4 page ids.
+  TwoQReplacer replacer(8);
+  for (frame_id_t frame_id = 1; frame_id <= 6; frame_id++) {
+    LoadPage(&replacer, frame_id, 100 + frame_id);
+  }
+  ASSERT_EQ(6, replacer.Size());
+
+  // Scenario: A1in holds more than Kin frames, so it is evicted in FIFO order. More accesses of a frame in A1in are
+  // correlated and do not protect it.
+  frame_id_t frame_id;
+  replacer.RecordAccess(3);
+  replacer.RecordAccess(3);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(2, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(3, frame_id);
+  ASSERT_EQ(3, replacer.Size());
+
+  // Scenario: page 101 is loaded again while it is remembered in A1out, so it goes to Am directly.
+  LoadPage(&replacer, 1, 101);
+  // A frame that is not evictable is never a victim.
+  LoadPage(&replacer, 2, 200);
+  replacer.SetEvictable(2, false);
+  ASSERT_EQ(4, replacer.Size());
+
+  // A1in = [4, 5, 6, (2)] is still larger than Kin.
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(4, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(5, frame_id);
+  // A1in = [6, (2)] is not larger than Kin any more, so the victim comes from Am.
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(1, frame_id);
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(6, frame_id);
+  ASSERT_FALSE(replacer.Evict(&frame_id));
+  ASSERT_EQ(0, replacer.Size());
+
+  replacer.SetEvictable(2, true);
+  replacer.Remove(2);
+  ASSERT_EQ(0, replacer.Size());
+}
+
+TEST(TwoQReplacerTest, AmIsLRUTest) {
+  TwoQReplacer replacer(8);
+  frame_id_t frame_id;
+  // Load pages 1..4 once and evict them, so that all of them are remembered in A1out.
+  for (frame_id_t i = 1; i <= 4; i++) {
+    LoadPage(&replacer, i, i);
+  }
+  for (frame_id_t i = 1; i <= 4; i++) {
+    ASSERT_TRUE(replacer.Evict(&frame_id));
+    EXPECT_EQ(i, frame_id);
+  }
+
+  // Loading them again puts all of them in Am, which is evicted in LRU order.
+  for (frame_id_t i = 1; i <= 4; i++) {
+    LoadPage(&replacer, i, i);
+  }
+  replacer.RecordAccess(1);
+  replacer.RecordAccess(3);
+  for (frame_id_t expected : {2, 4, 1, 3}) {
+    ASSERT_TRUE(replacer.Evict(&frame_id));
+    EXPECT_EQ(expected, frame_id);
+  }
+}
+
+TEST(TwoQReplacerTest, GhostQueueIsBoundedTest) {
+  // Kout = 4 page ids.
+  TwoQReplacer replacer(8);
+  frame_id_t frame_id;
+  for (page_id_t page_id = 0; page_id < 6; page_id++) {
+    LoadPage(&replacer, 1, page_id);
+    ASSERT_TRUE(replacer.Evict(&frame_id));
+  }
+
+  // Pages 0 and 1 were forgotten, pages 2..5 are remembered.
+  LoadPage(&replacer, 1, 0);
+  LoadPage(&replacer, 2, 5);
+  LoadPage(&replacer, 3, 100);
+  // Frames 1 and 3 are in A1in, frame 2 is in Am. A1in is not larger than Kin, so frame 2 goes first.
+  ASSERT_TRUE(replacer.Evict(&frame_id));
+  EXPECT_EQ(2, frame_id);
+}
+
+}  // namespace bustub
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_bulk_load_test.cpp
+//
+// Identification: test/storage/b_plus_tree_bulk_load_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+namespace {
+
+using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+using InternalPage = BPlusTreeInternalPage<GenericKey<8>, page_id_t, GenericComparator<8>>;
+
+auto MakeEntry(int64_t key) -> std::pair<GenericKey<8>, RID> {
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(key);
+  return {index_key, RID(static_cast<int32_t>(key >> 32), static_cast<uint32_t>(key & 0xFFFFFFFF))};
+}
+
+/** Check the size bounds of every page under page_id, and that all leaves are on the same level. */
+void CheckPage(BufferPoolManager *bpm, page_id_t page_id, bool is_root, int depth, int *leaf_depth, int *num_leaves) {
+  auto guard = bpm->FetchPageBasic(page_id);
+  const auto *page = guard.As<BPlusTreePage>();
+  if (page->IsLeafPage()) {
+    ASSERT_LT(page->GetSize(), page->GetMaxSize());
+    if (!is_root) {
+      ASSERT_GE(page->GetSize(), page->GetMinSize());
+    }
+    if (*leaf_depth == -1) {
+      *leaf_depth = depth;
+    }
+    ASSERT_EQ(*leaf_depth, depth);
+    (*num_leaves)++;
+    return;
+  }
+  const auto *internal = guard.As<InternalPage>();
+  ASSERT_LE(internal->GetSize(), internal->GetMaxSize());
+  ASSERT_GE(internal->GetSize(), is_root ? 2 : internal->GetMinSize());
+  for (int i = 0; i < internal->GetSize(); i++) {
+    CheckPage(bpm, internal->ValueAt(i), false, depth + 1, leaf_depth, num_leaves);
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeBulkLoadTest, BulkLoadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  const std::vector<std::pair<int, int>> max_sizes{{2, 2}, {2, 3}, {3, 3}, {5, 4}, {16, 16}};
+  for (auto [leaf_max_size, internal_max_size] : max_sizes) {
+    for (double fill_factor : {0.1, 0.5, 0.9, 1.0}) {
+      for (int64_t num_keys : {0, 1, 2, 7, 100, 1000}) {
+        auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+        auto bpm = std::make_unique<BufferPoolManager>(50, disk_manager.get());
+        page_id_t page_id;
+        bpm->NewPageGuarded(&page_id);
+        Tree tree("foo_pk", page_id, bpm.get(), comparator, leaf_max_size, internal_max_size);
+
+        // 乱序，带重复的key
+        std::vector<std::pair<GenericKey<8>, RID>> entries;
+        for (int64_t key = 0; key < num_keys; key++) {
+          entries.push_back(MakeEntry(key * 2));
+          if (key % 3 == 0) {
+            entries.push_back(MakeEntry(key * 2));
+          }
+        }
+        std::shuffle(entries.begin(), entries.end(), std::mt19937(num_keys));
+        ASSERT_TRUE(tree.BulkLoad(entries, fill_factor));
+        ASSERT_EQ(tree.IsEmpty(), num_keys == 0);
+
+        if (num_keys > 0) {
+          int leaf_depth = -1;
+          int num_leaves = 0;
+          CheckPage(bpm.get(), tree.GetRootPageId(), true, 0, &leaf_depth, &num_leaves);
+          if (fill_factor == 1.0 && num_keys > leaf_max_size) {
+            // 装满的话叶子数接近最少
+            EXPECT_LE(num_leaves, (num_keys + leaf_max_size - 2) / (leaf_max_size - 1) + 1);
+          }
+        }
+
+        int64_t expected = 0;
+        for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+          ASSERT_EQ((*iter).first.ToString(), expected * 2);
+          expected++;
+        }
+        ASSERT_EQ(expected, num_keys);
+
+        // 建好的树照常支持查找、插入和删除
+        for (int64_t key = 0; key < num_keys * 2; key++) {
+          std::vector<RID> result;
+          ASSERT_EQ(tree.GetValue(MakeEntry(key).first, &result), key % 2 == 0);
+        }
+        for (int64_t key = 0; key < num_keys; key++) {
+          auto [index_key, rid] = MakeEntry(key * 2 + 1);
+          ASSERT_TRUE(tree.Insert(index_key, rid));
+        }
+        // 内部页面最多两个孩子的时候插入会分裂出只有一个孩子的页面，Remove不支持给它们的孩子合并或重分配
+        if (internal_max_size > 2) {
+          for (int64_t key = 0; key < num_keys * 2; key++) {
+            tree.Remove(MakeEntry(key).first, nullptr);
+          }
+          ASSERT_TRUE(tree.IsEmpty());
+        }
+
+        // 树不空的时候不能批量建树
+        if (num_keys > 0) {
+          auto [index_key, rid] = MakeEntry(0);
+          ASSERT_EQ(tree.Insert(index_key, rid), internal_max_size > 2);
+          ASSERT_FALSE(tree.BulkLoad(entries, fill_factor));
+        }
+      }
+    }
+  }
+}
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -402,4 +403,199 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest2) {
   delete bpm;
 }
 
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, OptimisticLookupTest) {
+  // Lookups run optimistically while other threads split and merge pages under them, and must still find every key
+  // that is never removed.
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 3, 5);
+
+  std::vector<int64_t> stable_keys;
+  std::vector<int64_t> churn_keys;
+  for (int64_t key = 1; key <= 400; key++) {
+    (key % 2 == 0 ? stable_keys : churn_keys).push_back(key);
+  }
+  InsertHelper(&tree, stable_keys);
+
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (int round = 0; round < 3; round++) {
+      InsertHelper(&tree, churn_keys);
+      DeleteHelper(&tree, churn_keys);
+    }
+    done = true;
+  });
+  std::vector<std::thread> readers;
+  for (uint64_t tid = 0; tid < 2; tid++) {
+    readers.emplace_back([&, tid] {
+      while (!done) {
+        LookupHelper(&tree, stable_keys, tid);
+      }
+    });
+  }
+  writer.join();
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  std::vector<RID> result;
+  GenericKey<8> index_key;
+  for (auto key : churn_keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_FALSE(tree.GetValue(index_key, &result));
+  }
+  EXPECT_TRUE(result.empty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, OptimisticWriteTest) {
+  // Writers change leaves under only a leaf write latch, while other writers split and merge pages next to them. Small
+  // pages make most operations fall back to the pessimistic path, so both paths interleave.
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(50, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 4, 4);
+
+  const uint64_t num_threads = 4;
+  std::vector<int64_t> stable_keys;
+  std::vector<int64_t> churn_keys;
+  for (int64_t key = 1; key <= 2000; key++) {
+    (key % 3 == 0 ? stable_keys : churn_keys).push_back(key);
+  }
+  InsertHelper(&tree, churn_keys);
+
+  // 每个线程插入自己那份stable_keys，同时删除自己那份churn_keys
+  std::vector<std::thread> threads;
+  for (uint64_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      GenericKey<8> index_key;
+      for (size_t i = tid; i < std::max(stable_keys.size(), churn_keys.size()); i += num_threads) {
+        if (i < stable_keys.size()) {
+          index_key.SetFromInteger(stable_keys[i]);
+          ASSERT_TRUE(tree.Insert(index_key, RID(static_cast<uint32_t>(stable_keys[i]))));
+          ASSERT_FALSE(tree.Insert(index_key, RID(static_cast<uint32_t>(stable_keys[i]))));
+        }
+        if (i < churn_keys.size()) {
+          index_key.SetFromInteger(churn_keys[i]);
+          tree.Remove(index_key, nullptr);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  int64_t size = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), stable_keys[size]);
+    size++;
+  }
+  EXPECT_EQ(size, stable_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, BLinkScanTest) {
+  // Scans and lookups hold one latch at a time, while writers split, merge and redistribute the pages under them. Keys
+  // that stay in the tree all along must be seen by every scan exactly once and in order.
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto *bpm = new BufferPoolManager(256, disk_manager.get());
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", header_page->GetPageId(), bpm, comparator, 4, 4);
+
+  const uint64_t num_writers = 2;
+  const int num_readers = 2;
+  const int64_t num_keys = 1000;
+  std::vector<int64_t> stable_keys;
+  std::vector<int64_t> churn_keys;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    (key % 4 == 0 ? stable_keys : churn_keys).push_back(key);
+  }
+  InsertHelper(&tree, stable_keys);
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> writers;
+  for (uint64_t tid = 0; tid < num_writers; tid++) {
+    writers.emplace_back([&, tid] {
+      GenericKey<8> index_key;
+      for (int round = 0; round < 3; round++) {
+        for (size_t i = tid; i < churn_keys.size(); i += num_writers) {
+          index_key.SetFromInteger(churn_keys[i]);
+          tree.Insert(index_key, RID(static_cast<uint32_t>(churn_keys[i])));
+        }
+        for (size_t i = tid; i < churn_keys.size(); i += num_writers) {
+          index_key.SetFromInteger(churn_keys[i]);
+          tree.Remove(index_key, nullptr);
+        }
+      }
+    });
+  }
+
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; tid++) {
+    readers.emplace_back([&] {
+      do {
+        size_t next_stable = 0;
+        int64_t last_key = 0;
+        for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+          int64_t key = (*iter).first.ToString();
+          ASSERT_GT(key, last_key);
+          last_key = key;
+          if (key % 4 == 0) {
+            ASSERT_EQ(key, stable_keys[next_stable]);
+            next_stable++;
+          }
+        }
+        ASSERT_EQ(next_stable, stable_keys.size());
+
+        GenericKey<8> index_key;
+        for (size_t i = 0; i < stable_keys.size(); i += 7) {
+          index_key.SetFromInteger(stable_keys[i]);
+          auto iter = tree.Begin(index_key);
+          ASSERT_FALSE(iter.IsEnd());
+          ASSERT_EQ((*iter).first.ToString(), stable_keys[i]);
+        }
+      } while (!done);
+    });
+  }
+
+  for (auto &thread : writers) {
+    thread.join();
+  }
+  done = true;
+  for (auto &thread : readers) {
+    thread.join();
+  }
+
+  int64_t size = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+    ASSERT_EQ((*iter).first.ToString(), stable_keys[size]);
+    size++;
+  }
+  EXPECT_EQ(size, stable_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+}
+
 }  // namespace bustub
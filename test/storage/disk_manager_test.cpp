@@ -11,10 +11,18 @@
 //===----------------------------------------------------------------------===//
 
 #include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
+#include "buffer/replacer.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
+#include "storage/disk/disk_manager_posix.h"
 
 namespace bustub {
 
@@ -24,13 +32,24 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    // ctest runs the tests in parallel, so the tests that check the file size get a file of their own
+    const std::string test_name = ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    own_db_file_ = test_name + ".db";
+    own_log_file_ = test_name + ".log";
+    remove(own_db_file_.c_str());
+    remove(own_log_file_.c_str());
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove(own_db_file_.c_str());
+    remove(own_log_file_.c_str());
   };
+
+  std::string own_db_file_;
+  std::string own_log_file_;
 };
 
 // NOLINTNEXTLINE
@@ -75,4 +94,225 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PosixReadWritePageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  std::string db_file(own_db_file_);
+  {
+    auto dm = DiskManagerPosix(db_file);
+    std::strncpy(data, "A test string.", sizeof(data));
+    EXPECT_EQ(0, dm.GetDbFileSize());
+
+    // Scenario: reading past the end of the file gives a zeroed page.
+    std::memset(buf, 1, sizeof(buf));
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(0, buf[0]);
+    EXPECT_EQ(0, buf[BUSTUB_PAGE_SIZE - 1]);
+
+    dm.WritePage(0, data);
+    dm.ReadPage(0, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    EXPECT_EQ(BUSTUB_PAGE_SIZE, dm.GetDbFileSize());
+
+    // Scenario: writing beyond the end grows the file, the pages in between read as zeros.
+    std::memset(buf, 0, sizeof(buf));
+    dm.WritePage(5, data);
+    dm.ReadPage(5, buf);
+    EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+    EXPECT_EQ(6 * BUSTUB_PAGE_SIZE, dm.GetDbFileSize());
+    dm.ReadPage(3, buf);
+    EXPECT_EQ(0, buf[0]);
+    EXPECT_EQ(2, dm.GetNumWrites());
+
+    dm.ShutDown();
+  }
+
+  // Scenario: the size of an existing file is picked up when it is opened again.
+  auto dm = DiskManagerPosix(db_file);
+  EXPECT_EQ(6 * BUSTUB_PAGE_SIZE, dm.GetDbFileSize());
+  std::memset(buf, 0, sizeof(buf));
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PosixConcurrentReadWriteTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+  auto dm = DiskManagerPosix(own_db_file_);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      char data[BUSTUB_PAGE_SIZE];
+      char buf[BUSTUB_PAGE_SIZE];
+      for (int round = 0; round < 4; round++) {
+        // 每个线程写自己的页，页号交错，文件大小由多个线程一起推大
+        for (int i = 0; i < pages_per_thread; i++) {
+          const page_id_t page_id = i * num_threads + t;
+          std::memset(data, page_id + round, sizeof(data));
+          dm.WritePage(page_id, data);
+        }
+        for (int i = 0; i < pages_per_thread; i++) {
+          const page_id_t page_id = i * num_threads + t;
+          std::memset(data, page_id + round, sizeof(data));
+          dm.ReadPage(page_id, buf);
+          ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * pages_per_thread * BUSTUB_PAGE_SIZE, dm.GetDbFileSize());
+  EXPECT_EQ(num_threads * pages_per_thread * 4, dm.GetNumWrites());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PosixDirectIOTest) {
+  // Falls back to buffered I/O on file systems without O_DIRECT, the pages must round trip either way.
+  auto dm = DiskManagerPosix(own_db_file_, true);
+  alignas(BUSTUB_PAGE_SIZE) static char aligned[BUSTUB_PAGE_SIZE];
+  std::vector<char> unaligned(BUSTUB_PAGE_SIZE + 1);
+  char *data = unaligned.data() + 1;
+  std::strncpy(data, "An unaligned page.", BUSTUB_PAGE_SIZE);
+  std::strncpy(aligned, "An aligned page.", BUSTUB_PAGE_SIZE);
+
+  dm.WritePage(0, data);
+  dm.WritePage(1, aligned);
+
+  char buf[BUSTUB_PAGE_SIZE];
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  std::memset(aligned, 0, sizeof(aligned));
+  dm.ReadPage(1, aligned);
+  EXPECT_STREQ("An aligned page.", aligned);
+  std::memset(data, 0, BUSTUB_PAGE_SIZE);
+  dm.ReadPage(1, data);
+  EXPECT_STREQ("An aligned page.", data);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PosixWritePagesTest) {
+  auto dm = DiskManagerPosix(own_db_file_);
+  const std::vector<page_id_t> page_ids{7, 11, 3, 5, 10, 4};
+  std::vector<std::vector<char>> data;
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  for (auto page_id : page_ids) {
+    data.emplace_back(BUSTUB_PAGE_SIZE, static_cast<char>(page_id));
+  }
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    pages.emplace_back(page_ids[i], data[i].data());
+  }
+
+  // Scenario: the pages are sorted and written in runs of adjacent pages: 3-5, 7 and 10-11.
+  dm.WritePages(pages);
+  dm.Sync();
+  auto stats = dm.GetStats();
+  EXPECT_EQ(6, stats.pages_written_);
+  EXPECT_EQ(6 * BUSTUB_PAGE_SIZE, stats.bytes_written_);
+  EXPECT_EQ(3, stats.write_calls_);
+  EXPECT_EQ(1, stats.syncs_);
+  EXPECT_EQ(6, dm.GetNumWrites());
+  EXPECT_EQ(12 * BUSTUB_PAGE_SIZE, dm.GetDbFileSize());
+
+  char buf[BUSTUB_PAGE_SIZE];
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    dm.ReadPage(page_ids[i], buf);
+    EXPECT_EQ(std::memcmp(buf, data[i].data(), sizeof(buf)), 0);
+  }
+  dm.ReadPage(6, buf);
+  EXPECT_EQ(0, buf[0]);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, MmapReadPageTest) {
+  auto writer = DiskManagerPosix(own_db_file_);
+  std::vector<char> data(BUSTUB_PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    std::memset(data.data(), 'a' + page_id, BUSTUB_PAGE_SIZE);
+    writer.WritePage(page_id, data.data());
+  }
+
+  auto dm = DiskManagerMmap(own_db_file_);
+  EXPECT_EQ(4 * BUSTUB_PAGE_SIZE, dm.GetMappedSize());
+  char buf[BUSTUB_PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    dm.AdviseAccess(page_id, AccessType::Scan);
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ('a' + page_id, buf[0]);
+    EXPECT_EQ('a' + page_id, buf[BUSTUB_PAGE_SIZE - 1]);
+  }
+
+  // Scenario: a page past the end of the file reads as zeros.
+  dm.AdviseAccess(10, AccessType::Prefetch);
+  dm.ReadPage(10, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  // Scenario: pages appended to the file later are mapped when they are read.
+  std::memset(data.data(), 'z', BUSTUB_PAGE_SIZE);
+  writer.WritePage(10, data.data());
+  dm.ReadPage(10, buf);
+  EXPECT_EQ('z', buf[0]);
+  EXPECT_EQ(11 * BUSTUB_PAGE_SIZE, dm.GetMappedSize());
+
+  // Scenario: the mapping is read-only.
+  EXPECT_THROW(dm.WritePage(0, data.data()), Exception);
+
+  dm.ShutDown();
+  writer.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, PosixThrowBadFileTest) {
+  EXPECT_THROW(DiskManagerPosix("dev/null\\/foo/bar/baz/test.db"), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, UnlimitedMemoryConcurrentReadWriteTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 2048;
+  DiskManagerUnlimitedMemory dm;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&dm, t] {
+      char data[BUSTUB_PAGE_SIZE];
+      char buf[BUSTUB_PAGE_SIZE];
+      // 页号交错，几个线程同时往同一个段里装新页面
+      for (int i = 0; i < pages_per_thread; i++) {
+        const page_id_t page_id = i * num_threads + t;
+        std::memset(data, page_id, sizeof(data));
+        dm.WritePage(page_id, data);
+      }
+      for (int i = 0; i < pages_per_thread; i++) {
+        const page_id_t page_id = i * num_threads + t;
+        std::memset(data, page_id, sizeof(data));
+        dm.ReadPage(page_id, buf);
+        ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // 没写过的页面读出来什么也不改
+  char buf[BUSTUB_PAGE_SIZE];
+  std::memset(buf, 0x5a, sizeof(buf));
+  dm.ReadPage(num_threads * pages_per_thread, buf);
+  dm.ReadPage(-1, buf);
+  EXPECT_EQ(buf[0], 0x5a);
+  EXPECT_EQ(buf[BUSTUB_PAGE_SIZE - 1], 0x5a);
+
+  const auto max_pages = DiskManagerUnlimitedMemory::DIRECTORY_SEGMENTS * DiskManagerUnlimitedMemory::SEGMENT_PAGES;
+  EXPECT_THROW(dm.WritePage(static_cast<page_id_t>(max_pages), buf), Exception);
+}
+
 }  // namespace bustub
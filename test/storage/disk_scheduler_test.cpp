@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/logger.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_posix.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+namespace {
+
+/** A page aligned buffer, so that the pages can go through io_uring even with direct I/O. */
+struct alignas(BUSTUB_PAGE_SIZE) PageBuffer {
+  char data_[BUSTUB_PAGE_SIZE];
+};
+
+/** Holds every read until Release() is called. */
+class BlockingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    std::unique_lock<std::mutex> lock(mutex_);
+    num_blocked_++;
+    cv_.notify_all();
+    cv_.wait(lock, [this] { return released_; });
+  }
+
+  void WaitBlocked(int num_blocked) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this, num_blocked] { return num_blocked_ >= num_blocked; });
+  }
+
+  void Release() {
+    const std::lock_guard<std::mutex> guard(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int num_blocked_{0};
+  bool released_{false};
+};
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+
+  auto dm = std::make_unique<DiskManagerUnlimitedMemory>();
+  auto disk_scheduler = std::make_unique<DiskScheduler>(dm.get());
+
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto promise1 = disk_scheduler->CreatePromise();
+  auto future1 = promise1.get_future();
+  auto promise2 = disk_scheduler->CreatePromise();
+  auto future2 = promise2.get_future();
+
+  disk_scheduler->Schedule({/*is_write=*/true, data, /*page_id=*/0, std::move(promise1)});
+  disk_scheduler->Schedule({/*is_write=*/false, buf, /*page_id=*/0, std::move(promise2)});
+
+  ASSERT_TRUE(future1.get());
+  ASSERT_TRUE(future2.get());
+  ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+  EXPECT_FALSE(disk_scheduler->UsesIoUring());
+
+  disk_scheduler = nullptr;  // Call the DiskScheduler destructor to finish all scheduled jobs.
+  dm->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, PosixConcurrentTest) {
+  // Scenario: with a DiskManagerPosix the requests go through io_uring when the kernel supports it, through the worker
+  // threads otherwise. The pages must round trip either way, and the disk manager must see the writes.
+  for (bool use_io_uring : {true, false}) {
+    remove("disk_scheduler_test.db");
+    remove("disk_scheduler_test.log");
+    const int num_threads = 4;
+    const int pages_per_thread = 64;
+    auto dm = std::make_unique<DiskManagerPosix>("disk_scheduler_test.db");
+    {
+      DiskScheduler disk_scheduler(dm.get(), 8, use_io_uring);
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&disk_scheduler, t] {
+          std::vector<PageBuffer> pages(pages_per_thread);
+          std::vector<std::future<bool>> futures;
+          for (int i = 0; i < pages_per_thread; i++) {
+            const page_id_t page_id = i * num_threads + t;
+            std::memset(pages[i].data_, page_id, BUSTUB_PAGE_SIZE);
+            futures.push_back(disk_scheduler.ScheduleWrite(page_id, pages[i].data_));
+          }
+          for (auto &future : futures) {
+            ASSERT_TRUE(future.get());
+          }
+          futures.clear();
+          std::vector<PageBuffer> bufs(pages_per_thread);
+          for (int i = 0; i < pages_per_thread; i++) {
+            futures.push_back(disk_scheduler.ScheduleRead(i * num_threads + t, bufs[i].data_));
+          }
+          for (int i = 0; i < pages_per_thread; i++) {
+            ASSERT_TRUE(futures[i].get());
+            ASSERT_EQ(std::memcmp(bufs[i].data_, pages[i].data_, BUSTUB_PAGE_SIZE), 0);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      if (!use_io_uring) {
+        EXPECT_FALSE(disk_scheduler.UsesIoUring());
+      } else if (!disk_scheduler.UsesIoUring()) {
+        LOG_INFO("io_uring is not available, the worker threads were used");
+      }
+
+      // Scenario: reading past the end of the file gives a zeroed page.
+      PageBuffer buf;
+      std::memset(buf.data_, 1, BUSTUB_PAGE_SIZE);
+      ASSERT_TRUE(disk_scheduler.ScheduleRead(num_threads * pages_per_thread, buf.data_).get());
+      EXPECT_EQ(0, buf.data_[0]);
+      EXPECT_EQ(0, buf.data_[BUSTUB_PAGE_SIZE - 1]);
+    }
+    EXPECT_EQ(num_threads * pages_per_thread, dm->GetNumWrites());
+    EXPECT_EQ(num_threads * pages_per_thread * BUSTUB_PAGE_SIZE, dm->GetDbFileSize());
+    dm->ShutDown();
+  }
+  remove("disk_scheduler_test.db");
+  remove("disk_scheduler_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(DiskSchedulerTest, BoundedQueueTest) {
+  // Scenario: with a queue depth of 1 and a single worker, one request is executing and one is queued. Scheduling a
+  // third request blocks until there is room in the queue.
+  BlockingDiskManager dm;
+  DiskScheduler disk_scheduler(&dm, 1);
+  char buf[3][BUSTUB_PAGE_SIZE];
+  auto future0 = disk_scheduler.ScheduleRead(0, buf[0]);
+  dm.WaitBlocked(1);
+  auto future1 = disk_scheduler.ScheduleRead(1, buf[1]);
+
+  std::atomic<bool> scheduled{false};
+  std::future<bool> future2;
+  std::thread thread([&] {
+    future2 = disk_scheduler.ScheduleRead(2, buf[2]);
+    scheduled = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(scheduled);
+
+  dm.Release();
+  thread.join();
+  EXPECT_TRUE(scheduled);
+  EXPECT_TRUE(future0.get());
+  EXPECT_TRUE(future1.get());
+  EXPECT_TRUE(future2.get());
+}
+
+}  // namespace bustub
@@ -0,0 +1,199 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_page.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+auto RandomValue(TypeId type, std::mt19937_64 *gen) -> Value {
+  // 值域取得小一点，让相等的列经常出现，才会比较到后面的列
+  std::uniform_int_distribution<int64_t> dist(-3, 3);
+  const int64_t v = dist(*gen);
+  switch (type) {
+    case TypeId::BOOLEAN:
+      return ValueFactory::GetBooleanValue(v > 0);
+    case TypeId::TINYINT:
+      return ValueFactory::GetTinyIntValue(static_cast<int8_t>(v * 40));
+    case TypeId::SMALLINT:
+      return ValueFactory::GetSmallIntValue(static_cast<int16_t>(v * 10000));
+    case TypeId::INTEGER:
+      return ValueFactory::GetIntegerValue(static_cast<int32_t>(v * 700000000));
+    case TypeId::BIGINT:
+      return ValueFactory::GetBigIntValue(v << 60);
+    case TypeId::DECIMAL:
+      return ValueFactory::GetDecimalValue(static_cast<double>(v) * 0.75e100);
+    default:
+      throw Exception("unexpected type");
+  }
+}
+
+/** Check KeyLowerBound() against std::lower_bound on sorted keys of the columns, over ranges of every size. */
+template <size_t KeySize>
+void CheckKeyLowerBound(Schema *key_schema) {
+  GenericComparator<KeySize> comparator(key_schema);
+  ASSERT_TRUE(comparator.IsNormalized());
+  std::mt19937_64 gen(KeySize);
+  std::vector<std::pair<GenericKey<KeySize>, RID>> entries;
+  for (int i = 0; i < 300; i++) {
+    std::vector<Value> values;
+    for (uint32_t c = 0; c < key_schema->GetColumnCount(); c++) {
+      values.push_back(RandomValue(key_schema->GetColumn(c).GetType(), &gen));
+    }
+    entries.emplace_back();
+    entries.back().first.SetFromKey(Tuple(values, key_schema), key_schema);
+  }
+  auto less = [&comparator](const auto &lhs, const auto &rhs) { return comparator(lhs.first, rhs.first) < 0; };
+  std::sort(entries.begin(), entries.end(), less);
+
+  for (int begin : {0, 1, 5}) {
+    for (int end = begin; end <= static_cast<int>(entries.size()); end += end < 40 ? 1 : 37) {
+      for (const auto &probe : entries) {
+        auto expected = std::lower_bound(entries.begin() + begin, entries.begin() + end, probe, less) - entries.begin();
+        ASSERT_EQ(KeyLowerBound(entries.data(), begin, end, probe.first, comparator), expected) << begin << " " << end;
+      }
+    }
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, IntegerKeySearchTest) {
+  Schema bigint_schema({Column("a", TypeId::BIGINT)});
+  CheckKeyLowerBound<8>(&bigint_schema);
+  Schema integer_smallint_schema({Column("a", TypeId::INTEGER), Column("b", TypeId::SMALLINT)});
+  CheckKeyLowerBound<8>(&integer_smallint_schema);
+  Schema integer_schema({Column("a", TypeId::INTEGER)});
+  CheckKeyLowerBound<4>(&integer_schema);
+  Schema smallint_schema({Column("a", TypeId::SMALLINT), Column("b", TypeId::SMALLINT)});
+  CheckKeyLowerBound<4>(&smallint_schema);
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, NormalizedOrderTest) {
+  Schema key_schema({Column("a", TypeId::BOOLEAN), Column("b", TypeId::TINYINT), Column("c", TypeId::SMALLINT),
+                     Column("d", TypeId::INTEGER), Column("e", TypeId::BIGINT), Column("f", TypeId::DECIMAL)});
+  ASSERT_LE(key_schema.GetLength(), 32);
+  GenericComparator<32> comparator(&key_schema);
+  const auto column_count = key_schema.GetColumnCount();
+
+  std::mt19937_64 gen(0);
+  std::vector<std::vector<Value>> rows;
+  std::vector<GenericKey<32>> keys;
+  for (int i = 0; i < 200; i++) {
+    std::vector<Value> values;
+    for (uint32_t c = 0; c < column_count; c++) {
+      values.push_back(RandomValue(key_schema.GetColumn(c).GetType(), &gen));
+    }
+    GenericKey<32> key;
+    key.SetFromKey(Tuple(values, &key_schema), &key_schema);
+    rows.push_back(std::move(values));
+    keys.push_back(key);
+  }
+
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (uint32_t c = 0; c < column_count; c++) {
+      ASSERT_EQ(keys[i].ToValue(&key_schema, c).CompareEquals(rows[i][c]), CmpBool::CmpTrue);
+    }
+    for (size_t j = 0; j < rows.size(); j++) {
+      int expected = 0;
+      for (uint32_t c = 0; c < column_count && expected == 0; c++) {
+        if (rows[i][c].CompareLessThan(rows[j][c]) == CmpBool::CmpTrue) {
+          expected = -1;
+        } else if (rows[i][c].CompareGreaterThan(rows[j][c]) == CmpBool::CmpTrue) {
+          expected = 1;
+        }
+      }
+      ASSERT_EQ(comparator(keys[i], keys[j]), expected) << i << " " << j;
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, NullSortsFirstTest) {
+  Schema key_schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT), Column("c", TypeId::DECIMAL)});
+  GenericComparator<32> comparator(&key_schema);
+
+  GenericKey<32> null_key;
+  std::vector<Value> nulls{ValueFactory::GetNullValueByType(TypeId::INTEGER),
+                           ValueFactory::GetNullValueByType(TypeId::BIGINT),
+                           ValueFactory::GetNullValueByType(TypeId::DECIMAL)};
+  null_key.SetFromKey(Tuple(nulls, &key_schema), &key_schema);
+  for (uint32_t c = 0; c < key_schema.GetColumnCount(); c++) {
+    EXPECT_TRUE(null_key.ToValue(&key_schema, c).IsNull());
+  }
+
+  GenericKey<32> min_key;
+  std::vector<Value> mins{ValueFactory::GetIntegerValue(BUSTUB_INT32_MIN),
+                          ValueFactory::GetBigIntValue(BUSTUB_INT64_MIN),
+                          ValueFactory::GetDecimalValue(BUSTUB_DECIMAL_MIN)};
+  min_key.SetFromKey(Tuple(mins, &key_schema), &key_schema);
+  EXPECT_EQ(comparator(null_key, min_key), -1);
+  EXPECT_EQ(comparator(min_key, null_key), 1);
+  EXPECT_EQ(comparator(null_key, null_key), 0);
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, IntegerKeyTest) {
+  Schema key_schema({Column("a", TypeId::BIGINT)});
+  GenericComparator<8> comparator(&key_schema);
+  std::vector<int64_t> values{BUSTUB_INT64_MIN, -(int64_t{1} << 40), -256, -1, 0, 1, 255, 256, BUSTUB_INT64_MAX};
+  for (size_t i = 0; i < values.size(); i++) {
+    GenericKey<8> lhs;
+    lhs.SetFromInteger(values[i]);
+    EXPECT_EQ(lhs.ToString(), values[i]);
+    for (size_t j = 0; j < values.size(); j++) {
+      GenericKey<8> rhs;
+      rhs.SetFromInteger(values[j]);
+      EXPECT_EQ(comparator(lhs, rhs), i < j ? -1 : (i > j ? 1 : 0));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, ToStringTest) {
+  // Scenario: a 4-byte key from SetFromInteger() is a single INTEGER column, and is printed as one.
+  Schema integer_schema({Column("a", TypeId::INTEGER)});
+  GenericComparator<4> integer_comparator(&integer_schema);
+  GenericKey<4> small_key;
+  small_key.SetFromInteger(-7);
+  GenericKey<4> large_key;
+  large_key.SetFromInteger(BUSTUB_INT32_MAX);
+  EXPECT_EQ(-7, small_key.ToString());
+  EXPECT_EQ(BUSTUB_INT32_MAX, large_key.ToString());
+  EXPECT_EQ(-1, integer_comparator(small_key, large_key));
+  std::ostringstream os;
+  os << small_key;
+  EXPECT_EQ("-7", os.str());
+
+  // Scenario: keys of any other schema are printed column by column with the key schema.
+  Schema key_schema({Column("a", TypeId::SMALLINT), Column("b", TypeId::INTEGER), Column("c", TypeId::BIGINT)});
+  std::vector<Value> values{ValueFactory::GetSmallIntValue(-3), ValueFactory::GetIntegerValue(42),
+                            ValueFactory::GetBigIntValue(-(int64_t{1} << 40))};
+  GenericKey<16> key;
+  key.SetFromKey(Tuple(values, &key_schema), &key_schema);
+  EXPECT_EQ("(-3, 42, -1099511627776)", key.ToString(&key_schema));
+}
+
+}  // namespace bustub
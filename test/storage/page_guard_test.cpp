@@ -10,9 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 
 #include "buffer/buffer_pool_manager.h"
 #include "storage/disk/disk_manager_memory.h"
@@ -48,4 +51,111 @@ TEST(PageGuardTest, DISABLED_SampleTest) {
   disk_manager->ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST(PageGuardTest, OptimisticReadTest) {
+  const size_t buffer_pool_size = 5;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  bpm->UnpinPage(page_id, true);
+
+  // Scenario: readers, optimistic or not, do not invalidate an optimistic read.
+  {
+    auto guard = bpm->FetchPageOptimistic(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(guard.GetData(), "Hello"));
+    { auto read_guard = bpm->FetchPageRead(page_id); }
+    EXPECT_TRUE(guard.Validate());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  // Scenario: a writer invalidates an optimistic read, even if it did not change anything.
+  {
+    auto guard = bpm->FetchPageOptimistic(page_id);
+    { auto write_guard = bpm->FetchPageWrite(page_id); }
+    EXPECT_FALSE(guard.Validate());
+  }
+
+  // Scenario: an optimistic read that started while a writer holds the latch is never valid.
+  {
+    auto write_guard = bpm->FetchPageWrite(page_id);
+    auto guard = bpm->FetchPageOptimistic(page_id);
+    EXPECT_FALSE(guard.Validate());
+  }
+
+  // Scenario: a reader that gives up on optimistic reads takes the read latch and keeps the page pinned.
+  {
+    auto guard = bpm->FetchPageOptimistic(page_id);
+    auto read_guard = guard.Lock();
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_EQ(0, strcmp(read_guard.GetData(), "Hello"));
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  // The read latch was released, otherwise this would block.
+  { auto write_guard = bpm->FetchPageWrite(page_id); }
+
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(PageGuardTest, UpgradeDowngradeTest) {
+  const size_t buffer_pool_size = 5;
+
+  auto disk_manager = std::make_shared<DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_shared<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "Hello");
+  bpm->UnpinPage(page_id, true);
+  bpm->FlushPage(page_id);
+
+  // Scenario: the only reader upgrades, keeping its pin, and its modification marks the page dirty.
+  {
+    auto read_guard = bpm->FetchPageRead(page_id);
+    WritePageGuard write_guard;
+    ASSERT_TRUE(read_guard.TryUpgrade(&write_guard));
+    EXPECT_EQ(1, page->GetPinCount());
+    snprintf(write_guard.GetDataMut(), BUSTUB_PAGE_SIZE, "World");
+
+    // Scenario: downgrading keeps the pin and the dirty flag, and lets other readers in but no writer.
+    auto downgraded = write_guard.Downgrade();
+    EXPECT_EQ(1, page->GetPinCount());
+    {
+      auto other_read_guard = bpm->FetchPageRead(page_id);
+      EXPECT_EQ(0, strcmp(other_read_guard.GetData(), "World"));
+      // Scenario: upgrading fails while another reader holds the latch, and the guard keeps its read latch.
+      EXPECT_FALSE(downgraded.TryUpgrade(&write_guard));
+      EXPECT_EQ(0, strcmp(downgraded.GetData(), "World"));
+    }
+    EXPECT_EQ(1, page->GetPinCount());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+
+  // Scenario: upgrading fails while a writer waits for the latch, instead of deadlocking with it.
+  {
+    auto read_guard = bpm->FetchPageRead(page_id);
+    std::atomic<bool> written{false};
+    std::thread writer([&] {
+      auto guard = bpm->FetchPageWrite(page_id);
+      written = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    WritePageGuard write_guard;
+    EXPECT_FALSE(read_guard.TryUpgrade(&write_guard));
+    EXPECT_FALSE(written);
+    read_guard.Drop();
+    writer.join();
+    EXPECT_TRUE(written);
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  disk_manager->ShutDown();
+}
+
 }  // namespace bustub
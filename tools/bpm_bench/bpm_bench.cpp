@@ -1,3 +1,4 @@
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <memory>
@@ -6,6 +7,7 @@
 #include <sstream>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <cpp_random_distributions/zipfian_int_distribution.h>
@@ -13,7 +15,7 @@
 #include "argparse/argparse.hpp"
 #include "binder/binder.h"
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/util/string_util.h"
@@ -59,13 +61,21 @@ struct BpmTotalMetrics {
     auto scan_per_sec = scan_cnt_ / static_cast<double>(elsped) * 1000;
     auto get_per_sec = get_cnt_ / static_cast<double>(elsped) * 1000;
 
-    fmt::print("<<< BEGIN\n");
     fmt::print("scan: {}\n", scan_per_sec);
     fmt::print("get: {}\n", get_per_sec);
-    fmt::print(">>> END\n");
   }
 };
 
+/** Counts the pages read from disk, so that the hit ratio of the buffer pool can be computed. */
+class CountingDiskManager : public bustub::DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(bustub::page_id_t page_id, char *page_data) override {
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+    num_reads_++;
+  }
+  std::atomic<uint64_t> num_reads_{0};
+};
+
 struct BpmMetrics {
   uint64_t start_time_{0};
   uint64_t last_report_at_{0};
@@ -100,41 +110,38 @@ struct BpmMetrics {
   }
 };
 
-// NOLINTNEXTLINE
-auto main(int argc, char **argv) -> int {
+/** Access patterns of the get threads. */
+enum class Workload { Zipfian, ScanMixed, Looping };
+
+struct BenchOptions {
+  uint64_t duration_ms_;
+  uint64_t latency_ms_;
+  size_t writer_batch_;
+  uint64_t writer_interval_ms_;
+  Workload workload_;
+};
+
+/**
+ * Runs the benchmark against a buffer pool with the given replacement policy, and prints the throughput and the hit
+ * ratio of the buffer pool.
+ *
+ * - zipfian: get threads only, reading pages with a zipfian distribution.
+ * - scan-mixed: scan threads that write every page in order, next to zipfian get threads.
+ * - looping: get threads that read a range of pages slightly larger than the buffer pool over and over, which is the
+ *   worst case of LRU.
+ */
+void RunBench(bustub::ReplacerType replacer_type, const std::string &replacer_name, const BenchOptions &options) {
   using bustub::AccessType;
   using bustub::BufferPoolManager;
-  using bustub::DiskManagerUnlimitedMemory;
   using bustub::page_id_t;
 
-  argparse::ArgumentParser program("bustub-bpm-bench");
-  program.add_argument("--duration").help("run bpm bench for n milliseconds");
-  program.add_argument("--latency").help("set disk latency to n milliseconds");
-
-  try {
-    program.parse_args(argc, argv);
-  } catch (const std::runtime_error &err) {
-    std::cerr << err.what() << std::endl;
-    std::cerr << program;
-    return 1;
-  }
-
-  uint64_t duration_ms = 30000;
-  if (program.present("--duration")) {
-    duration_ms = std::stoi(program.get("--duration"));
-  }
-
-  uint64_t latency_ms = 0;
-  if (program.present("--latency")) {
-    latency_ms = std::stoi(program.get("--latency"));
-  }
-
-  auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
-  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE);
+  auto disk_manager = std::make_unique<CountingDiskManager>();
+  auto bpm = std::make_unique<BufferPoolManager>(BUSTUB_BPM_SIZE, disk_manager.get(), LRU_K_SIZE, nullptr,
+                                                 replacer_type);
   std::vector<page_id_t> page_ids;
 
-  fmt::print(stderr, "[info] total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
-             BUSTUB_PAGE_CNT, duration_ms, latency_ms, LRU_K_SIZE, BUSTUB_BPM_SIZE);
+  fmt::print(stderr, "[info] replacer={}, total_page={}, duration_ms={}, latency_ms={}, lru_k_size={}, bpm_size={}\n",
+             replacer_name, BUSTUB_PAGE_CNT, options.duration_ms_, options.latency_ms_, LRU_K_SIZE, BUSTUB_BPM_SIZE);
 
   for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
     page_id_t page_id;
@@ -150,7 +157,12 @@ auto main(int argc, char **argv) -> int {
   }
 
   // enable disk latency after creating all pages
-  disk_manager->SetLatency(latency_ms);
+  disk_manager->SetLatency(options.latency_ms_);
+  disk_manager->num_reads_ = 0;
+
+  if (options.writer_batch_ > 0) {
+    bpm->StartBackgroundWriter(options.writer_batch_, std::chrono::milliseconds(options.writer_interval_ms_));
+  }
 
   fmt::print(stderr, "[info] benchmark start\n");
 
@@ -158,8 +170,10 @@ auto main(int argc, char **argv) -> int {
   total_metrics.Begin();
 
   std::vector<std::thread> threads;
+  const uint64_t duration_ms = options.duration_ms_;
+  const size_t scan_threads = options.workload_ == Workload::ScanMixed ? BUSTUB_SCAN_THREAD : 0;
 
-  for (size_t thread_id = 0; thread_id < BUSTUB_SCAN_THREAD; thread_id++) {
+  for (size_t thread_id = 0; thread_id < scan_threads; thread_id++) {
     threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
       BpmMetrics metrics(fmt::format("scan {:>2}", thread_id), duration_ms);
       metrics.Begin();
@@ -190,17 +204,27 @@ auto main(int argc, char **argv) -> int {
     }));
   }
 
+  const Workload workload = options.workload_;
   for (size_t thread_id = 0; thread_id < BUSTUB_GET_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &page_ids, &bpm, duration_ms, &total_metrics, workload] {
       std::random_device r;
       std::default_random_engine gen(r());
       zipfian_int_distribution<size_t> dist(0, BUSTUB_PAGE_CNT - 1, 0.8);
+      // 循环访问的范围比缓冲池大一点
+      const size_t loop_size = BUSTUB_BPM_SIZE * 5 / 4;
+      size_t loop_idx = loop_size * thread_id / BUSTUB_GET_THREAD;
 
       BpmMetrics metrics(fmt::format("get  {:>2}", thread_id), duration_ms);
       metrics.Begin();
 
       while (!metrics.ShouldFinish()) {
-        auto page_idx = dist(gen);
+        size_t page_idx;
+        if (workload == Workload::Looping) {
+          page_idx = loop_idx;
+          loop_idx = (loop_idx + 1) % loop_size;
+        } else {
+          page_idx = dist(gen);
+        }
         auto *page = bpm->FetchPage(page_ids[page_idx], AccessType::Get);
         if (page == nullptr) {
           continue;
@@ -226,7 +250,88 @@ auto main(int argc, char **argv) -> int {
     thread.join();
   }
 
+  bpm->StopBackgroundWriter();
+  const uint64_t accesses = total_metrics.scan_cnt_ + total_metrics.get_cnt_;
+  const uint64_t reads = disk_manager->num_reads_.load();
+  fmt::print("<<< BEGIN\n");
+  fmt::print("replacer: {}\n", replacer_name);
   total_metrics.Report();
+  fmt::print("hit_ratio: {:.4f}\n", accesses == 0 ? 0.0 : 1.0 - reads / static_cast<double>(accesses));
+  fmt::print(">>> END\n");
+  fmt::print(stderr, "[info] foreground_writes={}, background_writes={}\n", bpm->GetForegroundWriteCount(),
+             bpm->GetBackgroundWriteCount());
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  using bustub::ReplacerType;
+
+  argparse::ArgumentParser program("bustub-bpm-bench");
+  program.add_argument("--duration").help("run bpm bench for n milliseconds");
+  program.add_argument("--latency").help("set disk latency to n milliseconds");
+  program.add_argument("--writer-batch").help("run a background writer that cleans n pages per round");
+  program.add_argument("--writer-interval").help("run the background writer every n milliseconds");
+  program.add_argument("--replacer").help("replacement policy: lruk, lru, clock, 2q, arc or all");
+  program.add_argument("--workload").help("access pattern: scan-mixed, zipfian or looping");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  BenchOptions options{30000, 0, 0, 10, Workload::ScanMixed};
+  if (program.present("--duration")) {
+    options.duration_ms_ = std::stoi(program.get("--duration"));
+  }
+
+  if (program.present("--latency")) {
+    options.latency_ms_ = std::stoi(program.get("--latency"));
+  }
+
+  if (program.present("--writer-batch")) {
+    options.writer_batch_ = std::stoi(program.get("--writer-batch"));
+  }
+
+  if (program.present("--writer-interval")) {
+    options.writer_interval_ms_ = std::stoi(program.get("--writer-interval"));
+  }
+
+  if (program.present("--workload")) {
+    auto workload = program.get("--workload");
+    if (workload == "zipfian") {
+      options.workload_ = Workload::Zipfian;
+    } else if (workload == "looping") {
+      options.workload_ = Workload::Looping;
+    } else if (workload != "scan-mixed") {
+      std::cerr << "unknown workload: " << workload << std::endl;
+      return 1;
+    }
+  }
+
+  const std::vector<std::pair<std::string, ReplacerType>> replacers{{"lruk", ReplacerType::LRUK},
+                                                                     {"lru", ReplacerType::LRU},
+                                                                     {"clock", ReplacerType::Clock},
+                                                                     {"2q", ReplacerType::TwoQ},
+                                                                     {"arc", ReplacerType::ARC}};
+  std::string replacer = "lruk";
+  if (program.present("--replacer")) {
+    replacer = program.get("--replacer");
+  }
+
+  bool found = false;
+  for (const auto &[name, type] : replacers) {
+    if (replacer == "all" || replacer == name) {
+      RunBench(type, name, options);
+      found = true;
+    }
+  }
+  if (!found) {
+    std::cerr << "unknown replacer: " << replacer << std::endl;
+    return 1;
+  }
 
   return 0;
 }
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/util/string_util.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+static const size_t BUSTUB_PAGE_CNT = 4096;
+
+/** Result of a run of the read-only hit benchmark. */
+struct HitBenchResult {
+  /** Fetch/unpin pairs completed per second. */
+  double throughput_;
+  /** Acquisitions of the buffer pool latch per fetch/unpin pair. Hits of resident pages should take none. */
+  double latch_per_op_;
+};
+
+/**
+ * Runs `num_threads` threads that fetch random resident pages for `duration_ms`, read them and unpin them without
+ * marking them dirty. Every page fits in the buffer pool, so this measures the cost of a hit and nothing else.
+ */
+auto RunHitBench(bustub::BufferPoolManager *bpm, const std::vector<bustub::page_id_t> &page_ids, size_t num_threads,
+                 uint64_t duration_ms) -> HitBenchResult {
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> total_cnt{0};
+  std::vector<std::thread> threads;
+
+  const auto latch_acquisitions = bpm->GetStats().latch_acquisitions_;
+  auto start_time = ClockMs();
+  for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+    threads.emplace_back([&, thread_id] {
+      std::default_random_engine gen(thread_id);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      uint64_t cnt = 0;
+      while (!stop.load(std::memory_order_relaxed)) {
+        auto page_idx = dist(gen);
+        auto *page = bpm->FetchPage(page_ids[page_idx], bustub::AccessType::Get);
+        if (page == nullptr) {
+          throw std::runtime_error("fetch page failed");
+        }
+        page->RLatch();
+        char ch = page->GetData()[page_idx % 1024];
+        page->RUnlatch();
+        if (ch == 0) {
+          throw std::runtime_error("invalid data");
+        }
+        bpm->UnpinPage(page_ids[page_idx], false, bustub::AccessType::Get);
+        cnt++;
+      }
+      total_cnt += cnt;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = ClockMs() - start_time;
+  // GetStats()本身也会拿一次latch_
+  const auto latch_delta = bpm->GetStats().latch_acquisitions_ - latch_acquisitions - 1;
+  return {total_cnt.load() / static_cast<double>(elapsed) * 1000,
+          static_cast<double>(latch_delta) / std::max<uint64_t>(total_cnt.load(), 1)};
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  using bustub::BufferPoolManager;
+  using bustub::DiskManagerUnlimitedMemory;
+  using bustub::page_id_t;
+  using bustub::ParallelBufferPoolManager;
+
+  argparse::ArgumentParser program("bustub-bpm-scale-bench");
+  program.add_argument("--duration").help("run each configuration for n milliseconds");
+  program.add_argument("--instances").help("number of buffer pool instances of the parallel buffer pool");
+  program.add_argument("--threads").help("comma separated list of thread counts, e.g. 1,2,4,8");
+  program.add_argument("--layout").help("frame layout of the buffer pool: per-page, arena or hugetlb");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = 3000;
+  if (program.present("--duration")) {
+    duration_ms = std::stoi(program.get("--duration"));
+  }
+
+  size_t num_instances = 16;
+  if (program.present("--instances")) {
+    num_instances = std::stoi(program.get("--instances"));
+  }
+
+  std::vector<size_t> thread_counts{1, 8, 32};
+  if (program.present("--threads")) {
+    thread_counts.clear();
+    for (const auto &s : bustub::StringUtil::Split(program.get("--threads"), ',')) {
+      thread_counts.push_back(std::stoi(s));
+    }
+  }
+
+  if (program.present("--layout")) {
+    auto layout = program.get("--layout");
+    if (layout == "per-page") {
+      bustub::buffer_pool_frame_layout = bustub::FrameLayout::PerPage;
+    } else if (layout == "arena") {
+      bustub::buffer_pool_frame_layout = bustub::FrameLayout::Arena;
+    } else if (layout == "hugetlb") {
+      bustub::buffer_pool_frame_layout = bustub::FrameLayout::HugeTlbArena;
+    } else {
+      std::cerr << "unknown frame layout: " << layout << std::endl;
+      return 1;
+    }
+  }
+
+  fmt::print(stderr, "[info] total_page={}, duration_ms={}, instances={}, layout={}\n", BUSTUB_PAGE_CNT, duration_ms,
+             num_instances, static_cast<int>(bustub::buffer_pool_frame_layout.load()));
+
+  fmt::print("<<< BEGIN\n");
+  for (size_t instances : std::vector<size_t>{1, num_instances}) {
+    auto disk_manager = std::make_unique<DiskManagerUnlimitedMemory>();
+    std::unique_ptr<BufferPoolManager> bpm;
+    if (instances == 1) {
+      bpm = std::make_unique<BufferPoolManager>(BUSTUB_PAGE_CNT, disk_manager.get());
+    } else {
+      // Give every instance some slack so that an uneven spread of page ids still fits in memory.
+      bpm = std::make_unique<ParallelBufferPoolManager>(instances, BUSTUB_PAGE_CNT / instances * 2,
+                                                        disk_manager.get());
+    }
+
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < BUSTUB_PAGE_CNT; i++) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      if (page == nullptr) {
+        throw std::runtime_error("new page failed");
+      }
+      page->GetData()[i % 1024] = 1;
+      bpm->UnpinPage(page_id, true);
+      page_ids.push_back(page_id);
+    }
+
+    for (auto num_threads : thread_counts) {
+      auto result = RunHitBench(bpm.get(), page_ids, num_threads, duration_ms);
+      fmt::print("instances={:<3} threads={:<3} hit: {:.0f} latch/op: {:.3f}\n", instances, num_threads,
+                 result.throughput_, result.latch_per_op_);
+    }
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
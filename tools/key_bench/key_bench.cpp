@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "catalog/schema.h"
+#include "fmt/core.h"
+#include "common/rid.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/b_plus_tree_page.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+auto ClockNs() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/** Compares two keys value by value, like GenericComparator does for keys that are not normalized. */
+template <size_t KeySize>
+auto CompareByValue(const bustub::GenericKey<KeySize> &lhs, const bustub::GenericKey<KeySize> &rhs,
+                    bustub::Schema *key_schema) -> int {
+  for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+    auto lhs_value = lhs.ToValue(key_schema, i);
+    auto rhs_value = rhs.ToValue(key_schema, i);
+    if (lhs_value.CompareLessThan(rhs_value) == bustub::CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs_value.CompareGreaterThan(rhs_value) == bustub::CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/** Binary search like BPlusTreeLeafPage::Lookup. */
+template <size_t KeySize, typename Compare>
+auto Lookup(const std::vector<bustub::GenericKey<KeySize>> &keys, const bustub::GenericKey<KeySize> &key,
+            const Compare &compare) -> size_t {
+  size_t lo = 0;
+  size_t hi = keys.size();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (compare(keys[mid], key) < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/**
+ * Look up random keys in a sorted array of keys, with the normalized comparator and with value by value comparisons,
+ * and in a sorted array of page entries with KeyLowerBound(), which compares 8-byte keys as integers. The key has as
+ * many BIGINT columns as fit in KeySize, and only the last one differs between keys, so that every comparison looks at
+ * all the columns.
+ */
+template <size_t KeySize>
+void RunBench(size_t num_keys, size_t num_ops) {
+  std::vector<bustub::Column> columns;
+  for (size_t i = 0; i < KeySize / sizeof(int64_t); i++) {
+    columns.emplace_back("c" + std::to_string(i), bustub::TypeId::BIGINT);
+  }
+  bustub::Schema key_schema(columns);
+  bustub::GenericComparator<KeySize> comparator(&key_schema);
+
+  std::vector<bustub::GenericKey<KeySize>> keys(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    std::vector<bustub::Value> values;
+    for (size_t c = 0; c < columns.size(); c++) {
+      auto v = c + 1 == columns.size() ? static_cast<int64_t>(i) * 2 - static_cast<int64_t>(num_keys) : 42;
+      values.push_back(bustub::ValueFactory::GetBigIntValue(v));
+    }
+    keys[i].SetFromKey(bustub::Tuple(values, &key_schema), &key_schema);
+  }
+
+  std::default_random_engine gen(0);
+  std::uniform_int_distribution<size_t> key_dist(0, num_keys - 1);
+  std::vector<size_t> probes(num_ops);
+  for (auto &probe : probes) {
+    probe = key_dist(gen);
+  }
+
+  size_t checksum = 0;
+  auto start = ClockNs();
+  for (auto probe : probes) {
+    checksum += Lookup(keys, keys[probe], comparator);
+  }
+  auto normalized_ns = ClockNs() - start;
+
+  start = ClockNs();
+  for (auto probe : probes) {
+    checksum -= Lookup(keys, keys[probe], [&key_schema](const auto &lhs, const auto &rhs) {
+      return CompareByValue(lhs, rhs, &key_schema);
+    });
+  }
+  auto value_ns = ClockNs() - start;
+
+  std::vector<std::pair<bustub::GenericKey<KeySize>, bustub::RID>> entries;
+  entries.reserve(num_keys);
+  for (const auto &key : keys) {
+    entries.emplace_back(key, bustub::RID());
+  }
+  start = ClockNs();
+  for (auto probe : probes) {
+    checksum += bustub::KeyLowerBound(entries.data(), 0, static_cast<int>(num_keys), keys[probe], comparator);
+  }
+  auto page_ns = ClockNs() - start;
+  for (auto probe : probes) {
+    checksum -= probe;
+  }
+  if (checksum != 0) {
+    throw std::runtime_error("lookups disagree");
+  }
+
+  fmt::print("GenericKey<{}> normalized: {:.1f} ns/lookup\n", KeySize, normalized_ns / static_cast<double>(num_ops));
+  fmt::print("GenericKey<{}> by value: {:.1f} ns/lookup\n", KeySize, value_ns / static_cast<double>(num_ops));
+  fmt::print("GenericKey<{}> page search: {:.1f} ns/lookup\n", KeySize, page_ns / static_cast<double>(num_ops));
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-key-bench");
+  program.add_argument("--keys").help("number of keys to search in");
+  program.add_argument("--ops").help("number of lookups of every phase");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_keys = 256;
+  if (program.present("--keys")) {
+    num_keys = std::stoi(program.get("--keys"));
+  }
+  size_t num_ops = 100000;
+  if (program.present("--ops")) {
+    num_ops = std::stoi(program.get("--ops"));
+  }
+
+  fmt::print(stderr, "[info] keys={}, ops={}\n", num_keys, num_ops);
+
+  fmt::print("<<< BEGIN\n");
+  RunBench<8>(num_keys, num_ops);
+  RunBench<64>(num_keys, num_ops);
+  fmt::print(">>> END\n");
+
+  return 0;
+}
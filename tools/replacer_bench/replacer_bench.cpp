@@ -0,0 +1,117 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/lru_k_replacer.h"
+#include "common/config.h"
+#include "fmt/core.h"
+
+auto ClockNs() -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  using bustub::frame_id_t;
+  using bustub::LRUKReplacer;
+
+  argparse::ArgumentParser program("bustub-replacer-bench");
+  program.add_argument("--frames").help("number of frames in the replacer");
+  program.add_argument("--k").help("lookback constant k of the LRU-K replacer");
+  program.add_argument("--ops").help("number of operations of every phase");
+  program.add_argument("--evictable").help("percentage of frames that are evictable (not pinned)");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_frames = 100000;
+  if (program.present("--frames")) {
+    num_frames = std::stoi(program.get("--frames"));
+  }
+  size_t k = bustub::LRUK_REPLACER_K;
+  if (program.present("--k")) {
+    k = std::stoi(program.get("--k"));
+  }
+  size_t num_ops = 1000000;
+  if (program.present("--ops")) {
+    num_ops = std::stoi(program.get("--ops"));
+  }
+  size_t evictable_pct = 10;
+  if (program.present("--evictable")) {
+    evictable_pct = std::stoi(program.get("--evictable"));
+  }
+
+  fmt::print(stderr, "[info] frames={}, k={}, ops={}, evictable={}%\n", num_frames, k, num_ops, evictable_pct);
+
+  LRUKReplacer replacer(num_frames, k);
+  std::default_random_engine gen(0);
+
+  // Every frame is accessed k times and pinned, then a share of them is unpinned, like a buffer pool where most pages
+  // are in use.
+  std::vector<frame_id_t> pinned;
+  std::vector<frame_id_t> unpinned;
+  for (size_t round = 0; round < k; round++) {
+    for (size_t i = 0; i < num_frames; i++) {
+      replacer.RecordAccess(static_cast<frame_id_t>(i));
+    }
+  }
+  for (size_t i = 0; i < num_frames; i++) {
+    if (i % 100 < evictable_pct) {
+      replacer.SetEvictable(static_cast<frame_id_t>(i), true);
+      unpinned.push_back(static_cast<frame_id_t>(i));
+    } else {
+      pinned.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+
+  // Hit: a random frame is accessed, pinned and unpinned again.
+  std::uniform_int_distribution<size_t> frame_dist(0, num_frames - 1);
+  auto start = ClockNs();
+  for (size_t i = 0; i < num_ops; i++) {
+    auto frame_id = static_cast<frame_id_t>(frame_dist(gen));
+    replacer.RecordAccess(frame_id);
+    replacer.SetEvictable(frame_id, false);
+    replacer.SetEvictable(frame_id, i % 100 < evictable_pct);
+  }
+  auto hit_ns = ClockNs() - start;
+
+  // Miss: a victim is evicted and pinned by its new page, and a random pinned frame is unpinned, so that the number of
+  // evictable frames stays the same.
+  pinned.clear();
+  for (size_t i = 0; i < num_frames; i++) {
+    replacer.SetEvictable(static_cast<frame_id_t>(i), i % 100 < evictable_pct);
+    if (i % 100 >= evictable_pct) {
+      pinned.push_back(static_cast<frame_id_t>(i));
+    }
+  }
+  start = ClockNs();
+  for (size_t i = 0; i < num_ops; i++) {
+    frame_id_t victim;
+    if (!replacer.Evict(&victim)) {
+      throw std::runtime_error("evict failed");
+    }
+    replacer.RecordAccess(victim);
+    replacer.SetEvictable(victim, false);
+    std::uniform_int_distribution<size_t> pinned_dist(0, pinned.size() - 1);
+    auto &unpin = pinned[pinned_dist(gen)];
+    replacer.SetEvictable(unpin, true);
+    unpin = victim;
+  }
+  auto miss_ns = ClockNs() - start;
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("hit: {:.1f} ns/op\n", hit_ns / static_cast<double>(num_ops));
+  fmt::print("miss: {:.1f} ns/op\n", miss_ns / static_cast<double>(num_ops));
+  fmt::print(">>> END\n");
+
+  return 0;
+}